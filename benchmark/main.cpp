@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2024 Stephen Punak
+ *
+ * Benchmark of the commit graph calculation.
+ *
+ * Generates a synthetic repository of the requested shape (or uses an
+ * existing one) and calculates its graph a number of times, printing the
+ * time and memory of each stage from Repository::commitGraph(GraphBuildStatistics&).
+ *
+ *   git2qt-benchmark --commits 100000 --branches 8 --merge-interval 4 --merge-parents 3 --stashes 10
+ *   git2qt-benchmark --repository /path/to/repository --iterations 5
+ *
+ * Stephen Punak, October 17, 2026
+*/
+#include "syntheticrepository.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <git2qt/graphbuildstatistics.h>
+#include <git2qt/repository.h>
+
+#include <limits>
+
+using namespace GIT;
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Commit graph benchmark");
+    parser.addHelpOption();
+    QCommandLineOption repositoryOption("repository", "Benchmark an existing repository instead of a generated one.", "path");
+    QCommandLineOption commitsOption("commits", "Number of commits to generate.", "count", "10000");
+    QCommandLineOption branchesOption("branches", "Number of branches alongside main.", "count", "4");
+    QCommandLineOption mergeIntervalOption("merge-interval", "Every N-th commit on main is a merge (0 for none).", "count", "10");
+    QCommandLineOption mergeParentsOption("merge-parents", "Parents of each merge (more than 2 for octopus merges).", "count", "2");
+    QCommandLineOption stashesOption("stashes", "Number of stashes to save.", "count", "0");
+    QCommandLineOption iterationsOption("iterations", "Number of times to calculate the graph.", "count", "3");
+    parser.addOptions({ repositoryOption, commitsOption, branchesOption, mergeIntervalOption, mergeParentsOption, stashesOption, iterationsOption });
+    parser.process(app);
+
+    QTextStream output(stdout);
+
+    QTemporaryDir temporaryDir;
+    QString path = parser.value(repositoryOption);
+    if(path.isEmpty()) {
+        SyntheticRepository synthetic(temporaryDir.path());
+        synthetic.setCommitCount(parser.value(commitsOption).toInt());
+        synthetic.setBranchCount(parser.value(branchesOption).toInt());
+        synthetic.setMergeInterval(parser.value(mergeIntervalOption).toInt());
+        synthetic.setMergeParentCount(parser.value(mergeParentsOption).toInt());
+        synthetic.setStashCount(parser.value(stashesOption).toInt());
+
+        output << "Generating " << synthetic.toString() << Qt::endl;
+        if(synthetic.generate() == false) {
+            output << synthetic.errorText() << Qt::endl;
+            return 1;
+        }
+        path = synthetic.path();
+    }
+
+    Repository repo(path);
+    if(repo.isNull()) {
+        output << "Failed to open " << path << ": " << repo.errorText() << Qt::endl;
+        return 1;
+    }
+
+    qint64 fastest = std::numeric_limits<qint64>::max();
+    int iterations = qMax(parser.value(iterationsOption).toInt(), 1);
+    for(int iteration = 0;iteration < iterations;iteration++) {
+        GraphBuildStatistics statistics;
+        repo.commitGraph(statistics);
+        if(statistics.isValid() == false) {
+            output << "Graph calculation failed: " << repo.errorText() << Qt::endl;
+            return 1;
+        }
+        output << "Iteration " << (iteration + 1) << ": " << statistics.toString();
+        fastest = qMin(fastest, statistics.totalNanoseconds());
+    }
+    output << "Fastest: " << QString::number(fastest / 1000000.0, 'f', 2) << " ms" << Qt::endl;
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include "syntheticrepository.h"
+
+#include <QDir>
+#include <QFile>
+
+const char* SyntheticRepository::FileName = "README";
+
+SyntheticRepository::SyntheticRepository(const QString& path) :
+    _path(path)
+{
+    git_libgit2_init();
+}
+
+SyntheticRepository::~SyntheticRepository()
+{
+    if(_tree != nullptr) {
+        git_tree_free(_tree);
+    }
+    if(_repo != nullptr) {
+        git_repository_free(_repo);
+    }
+    git_libgit2_shutdown();
+}
+
+bool SyntheticRepository::generate()
+{
+    if(git_repository_init(&_repo, _path.toUtf8().constData(), false) != 0) {
+        return fail("Failed to create repository");
+    }
+
+    return createTree() && createHistory() && createBranches() && createStashes();
+}
+
+QString SyntheticRepository::toString() const
+{
+    return QString("%1 commits, %2 branches, merge every %3 with %4 parents, %5 stashes")
+            .arg(_commitCount).arg(_branchCount).arg(_mergeInterval).arg(_mergeParentCount).arg(_stashCount);
+}
+
+// One tracked file, shared by every commit, so that stashes have something to save
+bool SyntheticRepository::createTree()
+{
+    bool result = false;
+    git_index* index = nullptr;
+    git_oid treeId;
+    if(writeFile("synthetic\n") &&
+       git_repository_index(&index, _repo) == 0 &&
+       git_index_add_bypath(index, FileName) == 0 &&
+       git_index_write(index) == 0 &&
+       git_index_write_tree(&treeId, index) == 0 &&
+       git_tree_lookup(&_tree, _repo, &treeId) == 0) {
+        result = true;
+    }
+    git_index_free(index);
+    return result ? true : fail("Failed to create tree");
+}
+
+/**
+ * Tip 0 is main and tips 1..branchCount are the branches. All of them start
+ * at the root commit, and commits are dealt to them round-robin.
+ */
+bool SyntheticRepository::createHistory()
+{
+    git_oid rootId;
+    if(createCommit(QVector<git_oid>(), &rootId) == false) {
+        return false;
+    }
+    _tips.fill(rootId, _branchCount + 1);
+
+    int mainCommits = 0;
+    int nextBranch = 1;
+    for(int i = 1;i < _commitCount;i++) {
+        int tip = i % _tips.count();
+
+        QVector<git_oid> parentIds;
+        parentIds.append(_tips.at(tip));
+        if(tip == 0 && _branchCount > 0 && _mergeInterval > 0 && ++mainCommits % _mergeInterval == 0) {
+            for(int parent = 1;parent < _mergeParentCount && parent <= _branchCount;parent++) {
+                parentIds.append(_tips.at(nextBranch));
+                nextBranch = nextBranch % _branchCount + 1;
+            }
+        }
+
+        if(createCommit(parentIds, &_tips[tip]) == false) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SyntheticRepository::createBranches()
+{
+    for(int tip = 0;tip < _tips.count();tip++) {
+        QString name = tip == 0 ? QString("refs/heads/main") : QString("refs/heads/branch-%1").arg(tip);
+        git_reference* reference = nullptr;
+        if(git_reference_create(&reference, _repo, name.toUtf8().constData(), &_tips.at(tip), true, nullptr) != 0) {
+            return fail(QString("Failed to create %1").arg(name));
+        }
+        git_reference_free(reference);
+    }
+
+    git_checkout_options options = GIT_CHECKOUT_OPTIONS_INIT;
+    options.checkout_strategy = GIT_CHECKOUT_FORCE;
+    if(git_repository_set_head(_repo, "refs/heads/main") != 0 ||
+       git_checkout_head(_repo, &options) != 0) {
+        return fail("Failed to check out main");
+    }
+    return true;
+}
+
+bool SyntheticRepository::createStashes()
+{
+    for(int i = 0;i < _stashCount;i++) {
+        git_signature* signature = nullptr;
+        git_oid stashId;
+        bool saved = writeFile(QString("stash %1\n").arg(i).toUtf8()) &&
+                     git_signature_new(&signature, "Benchmark", "benchmark@example.com", _commitTime++, 0) == 0 &&
+                     git_stash_save(&stashId, _repo, signature, QString("stash %1").arg(i).toUtf8().constData(), GIT_STASH_DEFAULT) == 0;
+        git_signature_free(signature);
+        if(saved == false) {
+            return fail(QString("Failed to save stash %1").arg(i));
+        }
+    }
+    return true;
+}
+
+bool SyntheticRepository::createCommit(const QVector<git_oid>& parentIds, git_oid* result)
+{
+    bool success = false;
+    QVector<const git_commit*> parents;
+    git_signature* signature = nullptr;
+
+    for(const git_oid& parentId : parentIds) {
+        git_commit* parent = nullptr;
+        if(git_commit_lookup(&parent, _repo, &parentId) == 0) {
+            parents.append(parent);
+        }
+    }
+
+    QByteArray message = QString("Commit %1\n").arg(_commitTime).toUtf8();
+    if(parents.count() == parentIds.count() &&
+       git_signature_new(&signature, "Benchmark", "benchmark@example.com", _commitTime++, 0) == 0 &&
+       git_commit_create(result, _repo, nullptr, signature, signature, nullptr, message.constData(), _tree, parents.count(), parents.data()) == 0) {
+        success = true;
+    }
+
+    git_signature_free(signature);
+    for(const git_commit* parent : parents) {
+        git_commit_free(const_cast<git_commit*>(parent));
+    }
+    return success ? true : fail("Failed to create commit");
+}
+
+bool SyntheticRepository::writeFile(const QByteArray& content)
+{
+    QFile file(QDir(_path).absoluteFilePath(FileName));
+    if(file.open(QIODevice::WriteOnly) == false || file.write(content) != content.length()) {
+        return fail(QString("Failed to write %1").arg(file.fileName()));
+    }
+    return true;
+}
+
+bool SyntheticRepository::fail(const QString& what)
+{
+    const git_error* error = git_error_last();
+    _errorText = error != nullptr && error->message != nullptr ? QString("%1: %2").arg(what).arg(error->message) : what;
+    return false;
+}
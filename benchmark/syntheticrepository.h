@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2024 Stephen Punak
+ *
+ * Generates a repository of a given shape for the graph benchmark.
+ *
+ * Commits are written straight to the object database and all share one
+ * tree, so that histories of hundreds of thousands of commits can be made
+ * in seconds. The shape is controlled by:
+ *
+ *   commitCount      - the total number of commits
+ *   branchCount      - the number of branches alongside main (fan-out).
+ *                      Commits are dealt round-robin to main and the branches.
+ *   mergeInterval    - every N-th commit on main merges the next branch(es)
+ *                      in turn. Zero for no merges.
+ *   mergeParentCount - parents of each merge. More than two makes octopus merges.
+ *   stashCount       - stashes saved on top of main once the history is written
+ *
+ * Stephen Punak, October 17, 2026
+*/
+#ifndef SYNTHETICREPOSITORY_H
+#define SYNTHETICREPOSITORY_H
+#include <QString>
+#include <QVector>
+
+#include <git2.h>
+
+class SyntheticRepository
+{
+public:
+    SyntheticRepository(const QString& path);
+    virtual ~SyntheticRepository();
+
+    int commitCount() const { return _commitCount; }
+    void setCommitCount(int value) { _commitCount = value; }
+
+    int branchCount() const { return _branchCount; }
+    void setBranchCount(int value) { _branchCount = value; }
+
+    int mergeInterval() const { return _mergeInterval; }
+    void setMergeInterval(int value) { _mergeInterval = value; }
+
+    int mergeParentCount() const { return _mergeParentCount; }
+    void setMergeParentCount(int value) { _mergeParentCount = value; }
+
+    int stashCount() const { return _stashCount; }
+    void setStashCount(int value) { _stashCount = value; }
+
+    QString path() const { return _path; }
+    QString errorText() const { return _errorText; }
+
+    bool generate();
+
+    QString toString() const;
+
+private:
+    bool createTree();
+    bool createHistory();
+    bool createBranches();
+    bool createStashes();
+    bool createCommit(const QVector<git_oid>& parentIds, git_oid* result);
+    bool writeFile(const QByteArray& content);
+    bool fail(const QString& what);
+
+    QString _path;
+    int _commitCount = 10000;
+    int _branchCount = 4;
+    int _mergeInterval = 10;
+    int _mergeParentCount = 2;
+    int _stashCount = 0;
+
+    git_repository* _repo = nullptr;
+    git_tree* _tree = nullptr;
+    QVector<git_oid> _tips;
+    qint64 _commitTime = 1700000000;
+    QString _errorText;
+
+    static const char* FileName;
+};
+
+#endif // SYNTHETICREPOSITORY_H
@@ -11,11 +11,15 @@
 #include <git2qt/signature.h>
 #include <git2qt/objectid.h>
 #include <git2qt/handle.h>
+#include <git2qt/commitcache.h>
+
+#include <QSharedPointer>
 
 namespace GIT {
 
 class Tree;
 class Repository;
+class CommitDetails;
 class GIT2QT_EXPORT Commit : public GitObject
 {
 public:
@@ -25,6 +29,7 @@ public:
 
 protected:
     Commit(GitEntityType entityType, Repository* repo, const ObjectId& objectId);
+    Commit(GitEntityType entityType, const Commit& other);
 
 public:
     virtual ~Commit();
@@ -34,28 +39,33 @@ public:
 
     static Commit lookup(Repository* repo, const ObjectId& objectId);
 
-    Signature author() const { return _author; }
-    void setAuthor(const Signature& value) { _author = value; }
+    // A commit whose header is already known, built without reading the object database
+    static Commit fromHeader(Repository* repo, const ObjectId& objectId, const CommitCache::Entry& entry);
+
+    Signature author() const;
+    void setAuthor(const Signature& value);
 
-    Signature committer() const { return _committer; }
-    void setCommitter(const Signature& value) { _committer = value; }
+    Signature committer() const;
+    void setCommitter(const Signature& value);
 
-    QString message() const { return _message; }
-    void setMessage(const QString& value) { _message = value; }
+    QString message() const;
+    void setMessage(const QString& value);
 
-    QString shortMessage() const { return _shortMessage; }
-    void setShortMessage(const QString& value) { _shortMessage = value; }
+    QString shortMessage() const;
+    void setShortMessage(const QString& value);
 
-    QString encoding() const { return _encoding; }
-    void setEncoding(const QString& value) { _encoding = value; }
+    QString encoding() const;
+    void setEncoding(const QString& value);
 
     QDateTime timestamp() const { return _timestamp; }
     void setTimestamp(const QDateTime& value) { _timestamp = value; }
 
 
-    ObjectId treeId() const;
+    ObjectId treeId() const { return _treeId; }
     Tree tree() const;
 
+    ObjectId::List parentIds() const { return _parentIds; }
+
     QVariant toVariant() const { return QVariant::fromValue<Commit>(*this); }
     static Commit fromVariant(const QVariant& value) { return value.value<Commit>(); }
 
@@ -102,15 +112,18 @@ public:
 
 private:
     void resolve();
+    void resolveHeader(const CommitCache::Entry& entry, const QSharedPointer<CommitDetails>& details);
+    void detachDetails();
 
-    static Commit createFromNative(Repository* repo, git_commit* commit);
+    static bool findHeader(Repository* repo, const ObjectId& objectId, CommitCache::Entry& entry, QSharedPointer<CommitDetails>& details);
 
-    Signature _author;
-    Signature _committer;
-    QString _message;
-    QString _shortMessage;
-    QString _encoding;
+    // Decoded from the commit header on construction
+    ObjectId _treeId;
+    ObjectId::List _parentIds;
     QDateTime _timestamp;
+
+    // Message, signatures and encoding, shared by copies and decoded on first access
+    QSharedPointer<CommitDetails> _details;
 };
 
 } // namespace GIT
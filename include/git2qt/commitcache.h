@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2024 Stephen Punak
+ *
+ * A per-repository LRU cache of decoded commit headers.
+ *
+ * Commit, GraphedCommit, CommitLog and the graph builder all resolve
+ * the same commits over and over. Entries here hold the parts of a
+ * commit which are cheap to keep and expensive to decode (tree id,
+ * parent ids, author and committer times and the summary) so that
+ * subsequent lookups do not need to go to libgit2 at all.
+ *
+ * Entries built from the commit-graph file carry no author time or
+ * summary (hasSummary() is false); those are decoded on demand.
+ *
+ * The cache is bounded by an approximate memory budget in bytes and is
+ * cleared whenever the owning repository reports a change.
+ *
+ * Stephen Punak, October 17, 2026
+*/
+#ifndef COMMITCACHE_H
+#define COMMITCACHE_H
+#include <git2qt/gitentity.h>
+#include <git2qt/objectid.h>
+
+#include <QCache>
+#include <QMutex>
+
+namespace GIT {
+
+class Repository;
+class GIT2QT_EXPORT CommitCache : public QObject,
+                                  public GitEntity
+{
+    Q_OBJECT
+public:
+    class Entry
+    {
+    public:
+        Entry() {}
+        Entry(const git_commit* commit);
+        Entry(const ObjectId& treeId, const ObjectId::List& parentIds, int64_t committerTime) :
+            _treeId(treeId), _parentIds(parentIds), _committerTime(committerTime) {}
+
+        ObjectId treeId() const { return _treeId; }
+        ObjectId::List parentIds() const { return _parentIds; }
+        int64_t authorTime() const { return _authorTime; }
+        int64_t committerTime() const { return _committerTime; }
+        QString summary() const { return _summary; }
+        bool hasSummary() const { return _hasSummary; }
+
+        qsizetype cost() const;
+        bool isValid() const { return _treeId.isValid(); }
+
+    private:
+        ObjectId _treeId;
+        ObjectId::List _parentIds;
+        int64_t _authorTime = 0;
+        int64_t _committerTime = 0;
+        QString _summary;
+        bool _hasSummary = false;
+    };
+
+    explicit CommitCache(Repository* repo);
+
+    bool find(const ObjectId& objectId, Entry& entry);
+    Entry insert(const ObjectId& objectId, const git_commit* commit);
+    void insert(const ObjectId& objectId, const Entry& entry);
+    bool contains(const ObjectId& objectId) const;
+
+    qsizetype maxMemory() const;
+    void setMaxMemory(qsizetype bytes);
+    qsizetype memoryUsed() const;
+    int count() const;
+
+    quint64 hits() const;
+    quint64 misses() const;
+    double hitRate() const;
+    void resetStatistics();
+
+    virtual bool isNull() const override { return repository() == nullptr; }
+
+    static const qsizetype DefaultMaxMemory = 32 * 1024 * 1024;
+
+public slots:
+    void clear();
+
+private:
+    mutable QMutex _mutex;
+    QCache<ObjectId, Entry> _cache;
+    quint64 _hits = 0;
+    quint64 _misses = 0;
+};
+
+} // namespace GIT
+
+#endif // COMMITCACHE_H
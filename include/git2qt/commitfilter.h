@@ -3,6 +3,8 @@
 #include <git2qt/gittypes.h>
 #include <git2qt/reference.h>
 
+#include <QStringList>
+
 namespace GIT {
 
 class Repository;
@@ -36,6 +38,10 @@ public:
     int maxResults() const { return _maxResults; }
     void setMaxResults(int value) { _maxResults = value; }
 
+    // Limit the history to commits which change these paths, like `git log -- <paths>`
+    QStringList paths() const { return _paths; }
+    void setPaths(const QStringList& value) { _paths = value; }
+
 private:
     CommitSortStrategies _sortBy;
     QString _includeReachableFromStr;
@@ -44,6 +50,7 @@ private:
     ObjectId::List _stopWhenFound;
     bool _firstParentOnly = false;
     int _maxResults = 0;
+    QStringList _paths;
 };
 
 
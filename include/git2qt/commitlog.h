@@ -9,20 +9,68 @@ namespace GIT {
 
 class Commit;
 class Repository;
+
+/**
+ * Walks the commit history described by a CommitFilter.
+ *
+ * performLookup() returns the whole walk at once. For large histories
+ * the log can instead be used as a pull-based cursor:
+ *
+ *     CommitLog log(repo, filter);
+ *     log.open(offset);
+ *     while(log.canFetchMore()) {
+ *         Commit::List batch = log.fetchNext(50);
+ *         ...
+ *     }
+ *
+ * Commits are only looked up as they are fetched, so a caller that
+ * stops early never pays for the rest of the history. Note that
+ * topological sorting forces libgit2 to walk the whole graph before
+ * the first commit is produced; time-only sorting does not.
+ *
+ * CommitFilter::maxResults() limits the commits fetched, not those passed
+ * over by open(offset) or skip(), so it is the size of a page.
+ *
+ * Path limiting (CommitFilter::setPaths()) needs the whole history to
+ * simplify it, so it is applied by performLookup() only, and maxResults
+ * then limits the commits which survive the simplification.
+ */
 class GIT2QT_EXPORT CommitLog : public GitEntity
 {
 public:
     CommitLog(Repository* repo, const CommitFilter& filter);
+    virtual ~CommitLog();
 
     Commit::List performLookup();
     void findReachableFrom(const Commit& commit);
 
+    // Incremental access
+    bool open(int offset = 0);
+    Commit::List fetchNext(int count);
+    ObjectId::List fetchNextObjectIds(int count);
+    int skip(int count);
+    bool canFetchMore() const { return _atEnd == false; }
+    int position() const { return _position; }
+    bool hasFailed() const { return _walkFailed; }
+    void close();
+
     virtual bool isNull() const override { return repository() != nullptr; }
 
 private:
     RevWalkHandle createWalkerHandle() const;
+    bool nextObjectId(ObjectId& objectId);
 
     CommitFilter _filter;
+
+    RevWalkHandle _walker;
+    ObjectId::Set _pendingStops;
+    int _maxResults = 0;
+    int _position = 0;
+    int _returned = 0;
+    bool _atEnd = true;
+    bool _walkFailed = false;
+
+    Q_DISABLE_COPY(CommitLog)
 };
 
 } // namespace GIT
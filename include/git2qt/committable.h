@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2024 Stephen Punak
+ *
+ * A columnar (struct-of-arrays) snapshot of a commit walk.
+ *
+ * Each commit produced by the walk is given a dense row index. Object
+ * ids, commit times, parent rows, interned authors and summaries are
+ * held in flat arrays indexed by that row, so history-wide scans touch
+ * contiguous memory instead of a list of Commit objects.
+ *
+ * Parents which were not produced by the walk (hidden, or beyond
+ * maxResults) are reported as NoRow by parentRows() but are still
+ * available as object ids from parentIds().
+ *
+ * The table is built in a single pass over the object database.
+ *
+ * Repository::findCommits(regex) scans the message arena of a table.
+ * The graph builder keeps its own arena of nodes (GraphBuilderCommit::Arena)
+ * and commitDistance() needs only the walk order, so neither uses a table.
+ *
+ * Stephen Punak, October 17, 2026
+*/
+#ifndef COMMITTABLE_H
+#define COMMITTABLE_H
+#include <git2qt/gitentity.h>
+#include <git2qt/commitfilter.h>
+#include <git2qt/objectid.h>
+
+#include <QHash>
+#include <QVector>
+
+namespace GIT {
+
+class Repository;
+class GIT2QT_EXPORT CommitTable : public GitEntity
+{
+public:
+    CommitTable(Repository* repo = nullptr);
+
+    bool build(const CommitFilter& filter, bool includeMessages = false);
+    void clear();
+
+    int count() const { return _objectIds.count(); }
+    bool isEmpty() const { return _objectIds.isEmpty(); }
+    bool hasMessages() const { return _hasMessages; }
+
+    int rowOf(const ObjectId& objectId) const { return _rows.value(objectId, NoRow); }
+    bool contains(const ObjectId& objectId) const { return _rows.contains(objectId); }
+
+    ObjectId objectIdAt(int row) const { return _objectIds.at(row); }
+    const ObjectId::List& objectIds() const { return _objectIds; }
+
+    int64_t commitTimeAt(int row) const { return _commitTimes.at(row); }
+    int64_t authorTimeAt(int row) const { return _authorTimes.at(row); }
+
+    int parentCount(int row) const { return _parentOffsets.at(row + 1) - _parentOffsets.at(row); }
+    int parentRow(int row, int parent) const { return _parentRows.at(_parentOffsets.at(row) + parent); }
+    const int* parentRows(int row) const { return _parentRows.constData() + _parentOffsets.at(row); }
+    ObjectId::List parentIds(int row) const;
+
+    int authorIndexAt(int row) const { return _authorIndexes.at(row); }
+    int authorCount() const { return _authorNames.count(); }
+    QString authorName(int authorIndex) const { return _authorNames.at(authorIndex); }
+    QString authorEmail(int authorIndex) const { return _authorEmails.at(authorIndex); }
+
+    QString summaryAt(int row) const;
+    QString messageAt(int row) const;
+
+    virtual bool isNull() const override { return repository() == nullptr; }
+
+    static const int NoRow = -1;
+
+private:
+    int internAuthor(const git_signature* signature);
+    static QString textAt(const QByteArray& arena, const QVector<int>& offsets, int row);
+
+    ObjectId::List _objectIds;
+    QHash<ObjectId, int> _rows;
+
+    QVector<int64_t> _commitTimes;
+    QVector<int64_t> _authorTimes;
+
+    // CSR parent edges: parents of row N are _parentRows[_parentOffsets[N] .. _parentOffsets[N+1])
+    QVector<int> _parentOffsets;
+    QVector<int> _parentRows;
+    ObjectId::List _parentIds;
+
+    QVector<int> _authorIndexes;
+    QStringList _authorNames;
+    QStringList _authorEmails;
+    QHash<QString, int> _authorPool;
+
+    // UTF-8 text arenas, row N spans [offsets[N] .. offsets[N+1])
+    QByteArray _summaryArena;
+    QVector<int> _summaryOffsets;
+    QByteArray _messageArena;
+    QVector<int> _messageOffsets;
+    bool _hasMessages = false;
+};
+
+} // namespace GIT
+
+#endif // COMMITTABLE_H
@@ -10,11 +10,15 @@
 #include <git2qt/gitentity.h>
 #include <git2qt/gittypes.h>
 #include <git2qt/diffdelta.h>
+#include <git2qt/lazydiff.h>
 #include <git2qt/handle.h>
 
+#include <QAtomicInt>
+
 namespace GIT {
 
 class DiffOptions;
+class DiffVisitor;
 class Tree;
 class TreeChanges;
 class CompareOptions;
@@ -35,21 +39,97 @@ public:
     GIT::DiffDelta::List diffIndexToWorkDir(const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags = DiffModifier::DiffModNone) const;
     GIT::DiffDelta::List diffTreeToWorkDir(const Tree& oldTree, const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags = DiffModifier::DiffModNone) const;
     GIT::DiffDelta::List diffTreeToTree(const Tree& oldTree, const Tree& newTree, const CompareOptions& compareOptions, DiffModifiers diffFlags = DiffModifier::DiffModNone) const;
+    GIT::DiffDelta::List diffTreeToTreeParallel(const Tree& oldTree, const Tree& newTree, const CompareOptions& compareOptions, DiffModifiers diffFlags = DiffModifier::DiffModNone, int threadCount = 0) const;
+
+    // Streaming variants, see DiffVisitor
+    bool diffIndexToWorkDir(const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffVisitor* visitor, DiffModifiers diffFlags = DiffModifier::DiffModNone) const;
+    bool diffTreeToWorkDir(const Tree& oldTree, const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffVisitor* visitor, DiffModifiers diffFlags = DiffModifier::DiffModNone) const;
+    bool diffTreeToTree(const Tree& oldTree, const Tree& newTree, const CompareOptions& compareOptions, DiffVisitor* visitor, DiffModifiers diffFlags = DiffModifier::DiffModNone) const;
+
+    // File lists whose patches are generated on demand, see LazyDiff
+    LazyDiff lazyDiffIndexToWorkDir(const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags = DiffModifier::DiffModNone) const;
+    LazyDiff lazyDiffTreeToWorkDir(const Tree& oldTree, const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags = DiffModifier::DiffModNone) const;
+    LazyDiff lazyDiffTreeToTree(const Tree& oldTree, const Tree& newTree, const CompareOptions& compareOptions, DiffModifiers diffFlags = DiffModifier::DiffModNone) const;
 
     virtual bool isNull() const override { return false; }
 
 private:
     DiffDelta::List loadDiffs(const DiffHandle& handle, const CompareOptions& compareOptions) const;
+    bool visitDiffs(const DiffHandle& handle, const CompareOptions& compareOptions, DiffVisitor* visitor) const;
+    LazyDiff createLazyDiff(const DiffHandle& handle, const CompareOptions& compareOptions) const;
+    class BlobPair;
+    void loadPatches(const QByteArray& repoPath, const QVector<BlobPair>& blobPairs, const CompareOptions& compareOptions, DiffModifiers diffFlags,
+                     QAtomicInt* next, DiffDelta* deltas, bool* patched) const;
+    DiffHandle createIndexToWorkDirDiff(const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags) const;
+    DiffHandle createTreeToWorkDirDiff(const Tree& oldTree, const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags) const;
+    DiffHandle createTreeToTreeDiff(const Tree& oldTree, const Tree& newTree, const CompareOptions& compareOptions, DiffModifiers diffFlags) const;
     DiffOptions buildDiffOptions(DiffModifiers diffOptions, const QStringList& paths, const CompareOptions& compareOptions) const;
     DiffHandle buildDiffList(const ObjectId& oldTreeId, DiffModifiers diffOptions, const QStringList& paths, const CompareOptions& compareOptions);
     void detectRenames(const DiffHandle& handle, const CompareOptions& compareOptions) const;
+    QByteArray configuredRenameDetection(const CompareOptions& compareOptions) const;
     TreeChanges buildTreeChanges(const DiffHandle& handle);
 
+    /**
+     * Payload of the git_diff_foreach() callbacks. libgit2 reports the binary,
+     * hunks and lines of a file right after the file itself, so the delta and
+     * hunk being filled are simply the last ones appended.
+     */
+    class DeltaCollector
+    {
+    public:
+        void appendDelta(const git_diff_delta* delta);
+        bool appendHunk(const git_diff_delta* delta, const git_diff_hunk* hunk);
+        DiffDelta* deltaFor(const git_diff_delta* delta);
+        DiffHunk* hunkFor(const git_diff_delta* delta, const git_diff_hunk* hunk);
+
+        DiffDelta::List takeDeltas() { return std::move(_deltas); }
+
+    private:
+        DiffDelta::List _deltas;
+        const git_diff_delta* _delta = nullptr;
+        const git_diff_hunk* _hunk = nullptr;
+    };
+
+    /**
+     * The two sides of one file of a diff, copied out of the git_diff on the
+     * calling thread so that a worker of diffTreeToTreeParallel() can
+     * generate its patch from the blobs alone.
+     */
+    class BlobPair
+    {
+    public:
+        BlobPair() {}
+        BlobPair(const git_diff_delta* delta);
+
+        ObjectId oldId() const { return _oldId; }
+        ObjectId newId() const { return _newId; }
+        QByteArray oldPath() const { return _oldPath; }
+        QByteArray newPath() const { return _newPath; }
+        uint16_t oldMode() const { return _oldMode; }
+        uint16_t newMode() const { return _newMode; }
+
+        bool hasPatch() const;
+
+    private:
+        ObjectId _oldId;
+        ObjectId _newId;
+        QByteArray _oldPath;
+        QByteArray _newPath;
+        uint16_t _oldMode = 0;
+        uint16_t _newMode = 0;
+        bool _changed = false;
+    };
+
     // Callbacks
     static int fileCallback(const git_diff_delta *delta, float progress, void *payload);
     static int binaryCallback(const git_diff_delta *d, const git_diff_binary *binary, void *payload);
     static int hunkCallback(const git_diff_delta *d, const git_diff_hunk *h, void *payload);
     static int lineCallback(const git_diff_delta *d, const git_diff_hunk *h, const git_diff_line *l, void *payload);
+
+    static int visitFileCallback(const git_diff_delta *delta, float progress, void *payload);
+    static int visitBinaryCallback(const git_diff_delta *delta, const git_diff_binary *binary, void *payload);
+    static int visitHunkCallback(const git_diff_delta *delta, const git_diff_hunk *hunk, void *payload);
+    static int visitLineCallback(const git_diff_delta *delta, const git_diff_hunk *hunk, const git_diff_line *line, void *payload);
 };
 
 } // namespace GIT
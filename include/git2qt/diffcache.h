@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2024 Stephen Punak
+ *
+ * A per-repository LRU cache of tree to tree diff results.
+ *
+ * A view which re-selects a commit asks for the same diff again, and
+ * comparing two trees always gives the same answer. Entries hold the
+ * DiffDelta::List (with its patches) of Diff::diffTreeToTree() and the
+ * TreeChanges of Diff::compare(fromTree, toTree, ...), keyed by both tree
+ * ids and the options which can change the result. Options which cannot,
+ * such as context lines for a compare(), are left out of the key so that
+ * such requests share an entry.
+ *
+ * Since trees are immutable, entries never need to be invalidated. The
+ * cache is bounded by an approximate memory budget in bytes; a budget of
+ * zero disables it.
+ *
+ * Stephen Punak, October 17, 2026
+*/
+#ifndef DIFFCACHE_H
+#define DIFFCACHE_H
+#include <git2qt/gitentity.h>
+#include <git2qt/diffdelta.h>
+#include <git2qt/treechanges.h>
+
+#include <QCache>
+#include <QMutex>
+
+namespace GIT {
+
+class CompareOptions;
+class DiffOptions;
+class Repository;
+class GIT2QT_EXPORT DiffCache : public GitEntity
+{
+public:
+    explicit DiffCache(Repository* repo);
+
+    bool findDeltas(const QByteArray& key, DiffDelta::List& deltas);
+    void insertDeltas(const QByteArray& key, const DiffDelta::List& deltas);
+
+    bool findChanges(const QByteArray& key, TreeChanges& changes);
+    void insertChanges(const QByteArray& key, const TreeChanges& changes);
+
+    qsizetype maxMemory() const;
+    void setMaxMemory(qsizetype bytes);
+    qsizetype memoryUsed() const;
+    int count() const;
+
+    quint64 hits() const;
+    quint64 misses() const;
+    double hitRate() const;
+    void resetStatistics();
+
+    void clear();
+
+    virtual bool isNull() const override { return repository() == nullptr; }
+
+    static QByteArray deltasKey(const ObjectId& oldTreeId, const ObjectId& newTreeId, const DiffOptions& options, const CompareOptions& compareOptions,
+                                const QByteArray& configuredRenames = QByteArray());
+    static QByteArray changesKey(const ObjectId& oldTreeId, const ObjectId& newTreeId, const DiffOptions& options);
+
+    static const qsizetype DefaultMaxMemory = 64 * 1024 * 1024;
+
+private:
+    class Entry
+    {
+    public:
+        Entry(const DiffDelta::List& deltas) :
+            _deltas(deltas) {}
+        Entry(const TreeChanges& changes) :
+            _changes(changes) {}
+
+        DiffDelta::List deltas() const { return _deltas; }
+        TreeChanges changes() const { return _changes; }
+
+        qsizetype cost() const;
+
+    private:
+        static qsizetype deltaCost(const DiffDelta& delta);
+
+        DiffDelta::List _deltas;
+        TreeChanges _changes;
+    };
+
+    static QByteArray makeKey(char kind, const ObjectId& oldTreeId, const ObjectId& newTreeId, const DiffOptions& options, DiffOptionFlags flags);
+
+    mutable QMutex _mutex;
+    QCache<QByteArray, Entry> _cache;
+    quint64 _hits = 0;
+    quint64 _misses = 0;
+};
+
+} // namespace GIT
+
+#endif // DIFFCACHE_H
@@ -24,6 +24,7 @@ public:
 
     DeltaType status() const { return _status; }
     DiffDeltaFlags flags() const { return _flags; }
+    void setFlags(DiffDeltaFlags value) { _flags = value; }
     int similarity() const { return _similarity; }
     int fileCount() const { return _fileCount; }
 
@@ -35,14 +36,22 @@ public:
 
     DiffBinary::List binaries() const { return _binaries; }
     void appendBinary(const DiffBinary& value) { _binaries.append(value); }
+    void appendBinary(DiffBinary&& value) { _binaries.append(std::move(value)); }
 
     DiffHunk::List hunks() const { return _hunks; }
     DiffHunk::List& hunksRef() { return _hunks; }
     void appendHunk(const DiffHunk& value) { _hunks.append(value); }
+    void appendHunk(DiffHunk&& value) { _hunks.append(std::move(value)); }
 
     DiffHunk findHunkForOldLine(int line) const { return _hunks.findHunkForOldLine(line); }
     DiffHunk findHunkForNewLine(int line) const { return _hunks.findHunkForNewLine(line); }
 
+    // Added and deleted line counts, only known once the patch has been generated
+    int linesAdded() const { return _linesAdded; }
+    int linesDeleted() const { return _linesDeleted; }
+    bool hasLineStats() const { return _hasLineStats; }
+    void setLineStats(int added, int deleted) { _linesAdded = added; _linesDeleted = deleted; _hasLineStats = true; }
+
     bool isValid() const { return _oldFile.isValid() || _newFile.isValid(); }
 
     QString toString() const;
@@ -79,7 +88,7 @@ public:
         DiffDelta* getDiffDeltaPtr(const DiffDelta& delta)
         {
             DiffDelta* result = nullptr;
-            auto it = std::find_if(begin(), end(), [delta](const DiffDelta& mine)
+            auto it = std::find_if(begin(), end(), [&delta](const DiffDelta& mine)
             {
                 return delta.oldFile().objectId() == mine.oldFile().objectId() && delta.newFile().objectId() == mine.newFile().objectId();
             });
@@ -98,6 +107,9 @@ private:
     int _fileCount = 0;
     DiffFile _oldFile;
     DiffFile _newFile;
+    int _linesAdded = 0;
+    int _linesDeleted = 0;
+    bool _hasLineStats = false;
 
     DiffBinary::List _binaries;
     DiffHunk::List _hunks;
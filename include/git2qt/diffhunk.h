@@ -30,6 +30,7 @@ public:
 
     DiffLine::List lines() const { return _lines; }
     void appendLine(const DiffLine& value) { _lines.append(value); }
+    void appendLine(DiffLine&& value) { _lines.append(std::move(value)); }
 
     bool isValid() const { return _header.isEmpty() == false; }
     QString toString() const;
@@ -60,7 +61,7 @@ public:
         DiffHunk* getDiffHunkPtr(const DiffHunk& hunk)
         {
             DiffHunk* result = nullptr;
-            auto it = std::find_if(begin(), end(), [hunk](const DiffHunk& mine)
+            auto it = std::find_if(begin(), end(), [&hunk](const DiffHunk& mine)
             {
                return mine == hunk;
             });
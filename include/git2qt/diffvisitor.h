@@ -0,0 +1,62 @@
+/**
+ * Copyright (c) 2024 Stephen Punak
+ *
+ * Receives a diff one piece at a time, straight from libgit2.
+ *
+ * Diff::diffTreeToTree(), diffIndexToWorkDir() and diffTreeToWorkDir()
+ * accept a visitor in place of returning a DiffDelta::List. For every file
+ * onFile() is called first, followed by onBinary() for binary files, or by
+ * onHunk() for each hunk, each one followed by onLine() for its lines.
+ * Nothing is kept between calls, so a patch of any size can be written to
+ * a file or socket in constant memory.
+ *
+ * Returning false from any callback stops the diff.
+ *
+ * Lines arrive as a DiffLineView whose content points into libgit2's buffer
+ * and is only valid during the call. Use toDiffLine() to keep a copy.
+ *
+ * Stephen Punak, October 17, 2026
+*/
+#ifndef DIFFVISITOR_H
+#define DIFFVISITOR_H
+#include <git2qt/diffdelta.h>
+#include <git2qt/declspec.h>
+
+#include <QByteArrayView>
+
+namespace GIT {
+
+class GIT2QT_EXPORT DiffLineView
+{
+public:
+    DiffLineView(const git_diff_line* line) :
+        _line(line) {}
+
+    QChar origin() const { return QChar(_line->origin); }
+    int oldLineNumber() const { return _line->old_lineno; }
+    int newLineNumber() const { return _line->new_lineno; }
+    int lineCount() const { return _line->num_lines; }
+    int64_t contentOffset() const { return _line->content_offset; }
+    QByteArrayView content() const { return QByteArrayView(_line->content, _line->content_len); }
+
+    DiffLine toDiffLine() const { return DiffLine(_line); }
+
+private:
+    const git_diff_line* _line;
+};
+
+class GIT2QT_EXPORT DiffVisitor
+{
+public:
+    virtual ~DiffVisitor() {}
+
+    // The delta carries the file's status and paths, but no hunks
+    virtual bool onFile(const DiffDelta& delta) { Q_UNUSED(delta) return true; }
+    virtual bool onBinary(const DiffBinary& binary) { Q_UNUSED(binary) return true; }
+    virtual bool onHunk(const DiffHunk& hunk) { Q_UNUSED(hunk) return true; }
+    virtual bool onLine(const DiffLineView& line) { Q_UNUSED(line) return true; }
+};
+
+} // namespace GIT
+
+#endif // DIFFVISITOR_H
@@ -64,6 +64,10 @@ public:
     static GitEntityType getGitEntityType(const QString& value) { return _GitEntityTypeToStringMap.getType(value); }
     static QList<GitEntityType> getGitEntityTypeValues() { return _GitEntityTypeToStringMap.getTypes(); }
 
+    static QString getGraphBuildStageString(GraphBuildStage value) { return _GraphBuildStageToStringMap.getString(value); }
+    static GraphBuildStage getGraphBuildStage(const QString& value) { return _GraphBuildStageToStringMap.getType(value); }
+    static QList<GraphBuildStage> getGraphBuildStageValues() { return _GraphBuildStageToStringMap.getTypes(); }
+
 private:
     class FileStatusToStringMap : public GIT::EnumToStringMap<FileStatus>
     {
@@ -237,9 +241,12 @@ private:
             insert(BlobEntity,                      "Blob");
             insert(BranchCollectionEntity,          "BranchCollection");
             insert(BranchEntity,                    "Branch");
+            insert(CommitCacheEntity,               "CommitCache");
             insert(CommitEntity,                    "Commit");
             insert(CommitLogEntity,                 "CommitLog");
+            insert(CommitTableEntity,               "CommitTable");
             insert(ConfigurationEntity,             "Configuration");
+            insert(DiffCacheEntity,                 "DiffCache");
             insert(DiffEntity,                      "Diff");
             insert(GraphedCommitEntity,             "GraphedCommit");
             insert(IndexEntity,                     "Index");
@@ -266,6 +273,22 @@ private:
         }
     };
 
+    class GraphBuildStageToStringMap : public EnumToStringMap<GraphBuildStage>
+    {
+    public:
+        GraphBuildStageToStringMap()
+        {
+            insert(GraphStageWalk,              "Walk");
+            insert(GraphStageStashes,           "Stashes");
+            insert(GraphStageLinking,           "Linking");
+            insert(GraphStageMerges,            "Merges");
+            insert(GraphStageBranchNames,       "BranchNames");
+            insert(GraphStageLevels,            "Levels");
+            insert(GraphStageLines,             "Lines");
+            insert(GraphStageComplete,          "Complete");
+        }
+    };
+
     static const FileStatusToStringMap _FileStatusToStringMap;
     static const ConfigurationLevelToStringMap _ConfigurationLevelToStringMap;
     static const DeltaTypeToStringMap _DeltaTypeToStringMap;
@@ -278,6 +301,7 @@ private:
     static const BranchTypeToStringMap _BranchTypeToStringMap;
     static const ChangeKindToStringMap _ChangeKindToStringMap;
     static const GitEntityTypeToStringMap _GitEntityTypeToStringMap;
+    static const GraphBuildStageToStringMap _GraphBuildStageToStringMap;
 };
 
 } // namespace GIT
@@ -540,9 +540,12 @@ enum GitEntityType {
     BlobEntity,
     BranchCollectionEntity,
     BranchEntity,
+    CommitCacheEntity,
     CommitEntity,
     CommitLogEntity,
+    CommitTableEntity,
     ConfigurationEntity,
+    DiffCacheEntity,
     DiffEntity,
     GraphBuilderEntity,
     GraphedCommitEntity,
@@ -946,6 +949,22 @@ enum GraphItemType
 };
 Q_DECLARE_FLAGS(GraphItemTypes, GraphItemType)
 
+/// <summary>
+/// The stages of a commit graph calculation, in the order they run.
+/// Reported as the progress value of Repository::commitGraphAsync().
+/// </summary>
+enum GraphBuildStage
+{
+    GraphStageWalk = 0,
+    GraphStageStashes,
+    GraphStageLinking,
+    GraphStageMerges,
+    GraphStageBranchNames,
+    GraphStageLevels,
+    GraphStageLines,
+    GraphStageComplete,
+};
+
 enum TagFetchMode {
     /**
      * Use the setting from the configuration.
@@ -1364,6 +1383,10 @@ GIT2QT_EXPORT QString getGitEntityTypeString(GitEntityType value);
 GIT2QT_EXPORT GitEntityType getGitEntityType(const QString& value);
 GIT2QT_EXPORT QList<GitEntityType> getGitEntityTypeValues();
 
+GIT2QT_EXPORT QString getGraphBuildStageString(GraphBuildStage value);
+GIT2QT_EXPORT GraphBuildStage getGraphBuildStage(const QString& value);
+GIT2QT_EXPORT QList<GraphBuildStage> getGraphBuildStageValues();
+
 } // namespace GIT
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(GIT::DiffDeltaFlags)
@@ -0,0 +1,59 @@
+/**
+ * Copyright (c) 2024 Stephen Punak
+ *
+ * Time spent in each stage of a commit graph calculation, and the memory
+ * in use as each stage finished.
+ *
+ * Filled in by Repository::commitGraph(GraphBuildStatistics&) so that the
+ * cost of calculating a graph can be measured against a real repository
+ * and compared between versions.
+ *
+ * Memory figures are read from /proc and are only available on Linux.
+ * The peak is that of the calculation alone; the process high-water mark
+ * is reset when it begins.
+ *
+ * Stephen Punak, October 17, 2026
+*/
+#ifndef GRAPHBUILDSTATISTICS_H
+#define GRAPHBUILDSTATISTICS_H
+#include <git2qt/gittypes.h>
+
+#include <QMap>
+#include <QString>
+
+namespace GIT {
+
+class GIT2QT_EXPORT GraphBuildStatistics
+{
+public:
+    GraphBuildStatistics() {}
+
+    QList<GraphBuildStage> stages() const { return _stageNanoseconds.keys(); }
+    qint64 stageNanoseconds(GraphBuildStage stage) const { return _stageNanoseconds.value(stage); }
+    qint64 stageResidentBytes(GraphBuildStage stage) const { return _stageResidentBytes.value(stage); }
+    qint64 totalNanoseconds() const;
+
+    qint64 peakResidentBytes() const { return _peakResidentBytes; }
+    int commitCount() const { return _commitCount; }
+
+    bool isValid() const { return _stageNanoseconds.count() > 0; }
+
+    QString toString() const;
+
+private:
+    friend class GraphBuilder;
+
+    void begin();
+    void addStage(GraphBuildStage stage, qint64 nanoseconds);
+    void merge(const GraphBuildStatistics& earlier);
+
+    QMap<GraphBuildStage, qint64> _stageNanoseconds;
+    QMap<GraphBuildStage, qint64> _stageResidentBytes;
+    qint64 _peakResidentBytes = 0;
+    bool _peakResettable = false;
+    int _commitCount = 0;
+};
+
+} // namespace GIT
+
+#endif // GRAPHBUILDSTATISTICS_H
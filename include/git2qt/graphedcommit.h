@@ -62,6 +62,16 @@ public:
     ObjectId mergedInto() const { return _mergedInto; }
     void setMergedInto(const ObjectId& value) { _mergedInto = value; }
 
+    ObjectId mergeBirth() const { return _mergeBirth; }
+    void setMergeBirth(const ObjectId& value) { _mergeBirth = value; }
+
+    // In a collapsed graph, a merge with the commits it brought in folded into it.
+    // The number of folded commits is counted when the graph is calculated.
+    bool isCollapsed() const { return _collapsed; }
+    void setCollapsed(bool value) { _collapsed = value; }
+    int collapsedCount() const { return _collapsedCount; }
+    void setCollapsedCount(int value) { _collapsedCount = value; }
+
     ObjectId stashBaseOf() const { return _stashBaseOf; }
     void setStashBaseOf(const ObjectId& value) { _stashBaseOf = value; }
 
@@ -132,7 +142,7 @@ public:
         {
             auto it = std::find_if(begin(), end(), [parentObjectId](GraphedCommit& c)
             {
-                return c.parents().objectIds().contains(parentObjectId);
+                return c.parentIds().contains(parentObjectId);
             });
             bool result = it != end();
             return result;
@@ -207,6 +217,8 @@ private:
     int _level = 0;
     int _maxLevel = 0;
     int _index = 0;
+    bool _collapsed = false;
+    int _collapsedCount = 0;
     QString _friendlyBranchName;
     QString _branchName;
     bool _head = false;
@@ -217,6 +229,7 @@ private:
     ObjectId _mergeBase;
     ObjectId _mergeFrom;
     ObjectId _mergedInto;
+    ObjectId _mergeBirth;
     ObjectId _stashBaseOf;
     QStringList _branchBases;
     ObjectId::List _parentObjectIds;
@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2024 Stephen Punak
+ *
+ * The lane layout of a commit graph, from which GraphLines are drawn
+ * on demand.
+ *
+ * Holds the level, merge sources and parent rows of every row of a
+ * graph calculated by Repository::commitGraph(). graphLines() draws the
+ * glyphs for a window of rows only, replaying just the commits whose
+ * lines pass through that window, so a view can scroll a very long
+ * history in time proportional to the rows it shows.
+ *
+ * Stephen Punak, October 17, 2026
+*/
+#ifndef GRAPHLAYOUT_H
+#define GRAPHLAYOUT_H
+#include <git2qt/graphline.h>
+#include <git2qt/declspec.h>
+
+#include <QVector>
+
+namespace GIT {
+
+class GIT2QT_EXPORT GraphLayout
+{
+public:
+    GraphLayout() {}
+
+    int rowCount() const { return _levels.count(); }
+    int level(int row) const { return _levels.at(row); }
+    bool isValid() const { return _levels.count() > 0; }
+
+    GraphLine graphLine(int row) const;
+    GraphLine::List graphLines(int firstRow, int count) const;
+
+    static const int NoRow = -1;
+
+private:
+    friend class GraphBuilder;
+
+    void addRow(int level, bool merge, int mergeFromRow, int mergeBaseRow, const QList<int>& parentRows);
+    void buildIndex();
+
+    class Window
+    {
+    public:
+        Window(int firstRow, int count) :
+            _firstRow(firstRow), _lines(count) {}
+
+        int firstRow() const { return _firstRow; }
+        int endRow() const { return _firstRow + _lines.count(); }
+        void set(int row, int level, GraphItemTypes types)
+        {
+            if(row >= _firstRow && row < endRow()) {
+                _lines[row - _firstRow].setGraphItem(level, types);
+            }
+        }
+        GraphLine::List lines() const;
+
+    private:
+        int _firstRow;
+        QVector<GraphLine> _lines;
+    };
+
+    void drawRow(int row, Window& window) const;
+    void drawMergeLine(int row, int toRow, int lineLevel, Window& window) const;
+    void drawVertical(int fromRow, int toRow, int level, Window& window) const;
+    static void drawHorizontal(int row, int fromLevel, int toLevel, Window& window);
+
+    QVector<int> _levels;
+    QVector<bool> _merges;
+    QVector<int> _mergeFromRows;
+    QVector<int> _mergeBaseRows;
+    QVector<int> _reach;
+
+    // CSR parent rows: parents of row N are _parentRows[_parentOffsets[N] .. _parentOffsets[N+1])
+    QVector<int> _parentOffsets = { 0 };
+    QVector<int> _parentRows;
+
+    // for each bucket of BucketSize rows, the rows above it whose lines reach into it
+    QVector<QVector<int>> _crossingRows;
+
+    static const int BucketSize = 256;
+};
+
+} // namespace GIT
+
+#endif // GRAPHLAYOUT_H
@@ -3,28 +3,57 @@
 #include <git2qt/gittypes.h>
 #include <git2qt/objectid.h>
 
+#include <QVector>
+
 namespace GIT {
 
+/**
+ * The graph glyphs for one row, one set of GraphItemTypes per level.
+ *
+ * Every GraphItemType fits in 16 bits, so the flags for the first
+ * InlineLevels levels are stored in the object itself and only wider
+ * rows spill into an overflow vector. Renderers should iterate with
+ *
+ *     for(int level = 0;level < line.levelCount();level++) {
+ *         GraphItemTypes items = line.graphItem(level);
+ *         ...
+ *     }
+ *
+ * which does not allocate. graphItems() builds a QMap and is kept for
+ * compatibility.
+ */
 class GIT2QT_EXPORT GraphLine
 {
 public:
     GraphLine() {}
 
-    QMap<int, GraphItemTypes> graphItems() const { return _graphItems; }
-    void setGraphItem(int level, GraphItemTypes types)
-    {
-        _graphItems[level] |= types;
-    }
+    GraphItemTypes graphItem(int level) const { return GraphItemTypes::fromInt(rawItem(level)); }
+    void setGraphItem(int level, GraphItemTypes types);
+    int levelCount() const { return _levelCount; }
+
+    QMap<int, GraphItemTypes> graphItems() const;
     void makeHorizontals(int fromLevel, int toLevel);
     bool hasHorizontal(int atLevel) const;
 
-    bool isValid() const { return _graphItems.count() != 0; }
+    bool isValid() const { return _levelCount != 0; }
 
     class List : public QList<GraphLine> {};
     class Map : public QMap<GIT::ObjectId, GraphLine> {};
 
+    static const int InlineLevels = 8;
+
 private:
-    QMap<int, GraphItemTypes> _graphItems;
+    quint16 rawItem(int level) const
+    {
+        if(level < 0 || level >= _levelCount) {
+            return 0;
+        }
+        return level < InlineLevels ? _inline[level] : _overflow.at(level - InlineLevels);
+    }
+
+    quint16 _inline[InlineLevels] = { 0 };
+    quint16 _levelCount = 0;
+    QVector<quint16> _overflow;
 };
 
 } // namespace GIT
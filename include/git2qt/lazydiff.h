@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2024 Stephen Punak
+ *
+ * A diff whose file patches are only generated when asked for.
+ *
+ * Diff::lazyDiffTreeToTree() answers one of these as soon as libgit2 has
+ * compared the two trees, which needs nothing more than the tree entries.
+ * deltas() lists every changed file with its status, paths and object ids
+ * but no hunks. patch() then generates the hunks and lines of a single
+ * file from the retained git_diff.
+ *
+ * Line statistics (as in `git diff --numstat`) need the content of every
+ * file, so they are only calculated when asked for.
+ *
+ * The repository must outlive the LazyDiff. Copies share the same git_diff,
+ * which is freed with the last of them. As with every libgit2 object, a
+ * LazyDiff must not be used from more than one thread at a time.
+ *
+ * Stephen Punak, October 17, 2026
+*/
+#ifndef LAZYDIFF_H
+#define LAZYDIFF_H
+#include <git2qt/diffdelta.h>
+#include <git2qt/declspec.h>
+
+#include <QSharedPointer>
+
+namespace GIT {
+
+class GIT2QT_EXPORT LazyDiff
+{
+public:
+    LazyDiff() {}
+
+    int count() const;
+
+    // Status, paths and object ids only
+    DiffDelta delta(int index) const;
+    DiffDelta::List deltas(bool withLineStats = false) const;
+
+    // The delta at index with its hunks and lines
+    DiffDelta patch(int index) const;
+    DiffDelta patch(const QString& path) const;
+
+    int indexOf(const QString& path) const;
+
+    bool isNull() const { return _diff.isNull(); }
+
+private:
+    friend class Diff;
+
+    LazyDiff(git_diff* diff);
+
+    bool loadLineStats(int index, DiffDelta& delta) const;
+    static bool loadLineStats(git_patch* patch, DiffDelta& delta);
+    static void loadHunks(git_patch* patch, DiffDelta& delta);
+
+    QSharedPointer<git_diff> _diff;
+};
+
+} // namespace GIT
+
+#endif // LAZYDIFF_H
@@ -26,6 +26,10 @@ public:
 
     QByteArray readBlobData(const Blob& blob);
 
+    // Commit-graph (objects/info/commit-graph)
+    bool writeCommitGraph();
+    bool isCommitGraphStale() const;
+
     virtual bool isNull() const { return false; }
 
     ObjectDatabaseHandle createHandle() const;
@@ -13,11 +13,17 @@
 #include <QString>
 #include <QList>
 #include <QVariant>
+#include <QHash>
+#include <QtEndian>
+#include <cstring>
 #include <git2qt/declspec.h>
 
 namespace GIT {
 
 class Reference;
+class ObjectId;
+
+size_t qHash(const ObjectId& key, size_t seed = 0) noexcept;
 
 class GIT2QT_EXPORT ObjectId
 {
@@ -29,28 +35,29 @@ public:
     ObjectId(const git_object* obj);
     ObjectId(const QString& sha);
 
-    bool operator ==(const ObjectId& other) const { return _sha == other._sha; }
+    bool operator ==(const ObjectId& other) const { return memcmp(_oid.id, other._oid.id, _rawSize) == 0; }
     bool operator !=(const ObjectId& other) const { return !(*this == other); }
-    bool operator <(const ObjectId& other) const { return _sha < other._sha; }
-    bool operator >(const ObjectId& other) const { return _sha > other._sha; }
+    bool operator <(const ObjectId& other) const { return memcmp(_oid.id, other._oid.id, _rawSize) < 0; }
+    bool operator >(const ObjectId& other) const { return memcmp(_oid.id, other._oid.id, _rawSize) > 0; }
 
-    bool operator ==(const QString& sha) const { return _sha == sha; }
+    bool operator ==(const QString& sha) const { return this->sha() == sha; }
     bool operator !=(const QString& other) const { return !(*this == other); }
 
     static ObjectId createFromHandle(git_reference* handle);
     static ObjectId createFromReference(const Reference& reference);
 
-    QString sha() const { return _sha; }
-    GitOid oid() const { return _oid; }
+    QString sha() const { return toString(); }
+    GitOid oid() const { return GitOid(_oid); }
 
-    uint64_t p1() const { return _p1; }
-    uint64_t p2() const { return _p2; }
-    uint64_t p3() const { return _p3; }
+    uint64_t p1() const { return qFromBigEndian<quint64>(_oid.id); }
+    uint64_t p2() const { return qFromBigEndian<quint64>(_oid.id + 8); }
+    uint64_t p3() const { return qFromBigEndian<quint32>(_oid.id + 16); }
 
-    const git_oid* toNative() const { return _oid.toNative(); }
+    const unsigned char* rawData() const { return _oid.id; }
+    const git_oid* toNative() const { return &_oid; }
 
-    QString toString(int count = 0) const { return count == 0 ? _sha : _sha.left(count); }
-    bool isValid() const { return _oid.isEmtpy() == false; }
+    QString toString(int count = 0) const;
+    bool isValid() const { return memcmp(_oid.id, Empty.id, _rawSize) != 0; }
     bool isNull() const { return !isValid(); }
 
     QVariant toVariant() const { return QVariant::fromValue<ObjectId>(*this); }
@@ -96,30 +103,38 @@ public:
     };
 
 private:
-    void calculateParts();
-
-    GitOid _oid;
-    QString _sha;
-
-    uint64_t _p1 = 0;
-    uint64_t _p2 = 0;
-    uint64_t _p3 = 0;
+    // Raw 20-byte id only. The hex string is produced on demand by toString().
+    git_oid _oid = { { 0 } };
 
+    static const git_oid Empty;
     static const int _rawSize = GitOid::Size;
 
 public:
     static const int HexSize = GitOid::Size * 2;
 };
 
+inline size_t qHash(const ObjectId& key, size_t seed) noexcept
+{
+    return qHashBits(key.rawData(), GitOid::Size, seed);
+}
+
 } // namespace GIT
 
 namespace std {
 
 template <> struct hash<GIT::ObjectId>
 {
-    size_t operator()(const GIT::ObjectId &key, size_t seed) const
+    size_t operator()(const GIT::ObjectId &key) const noexcept
+    {
+        // object ids are uniformly distributed, so the leading bytes make a good hash
+        size_t result;
+        memcpy(&result, key.rawData(), sizeof(result));
+        return result;
+    }
+
+    size_t operator()(const GIT::ObjectId &key, size_t seed) const noexcept
     {
-        return qHashMulti(seed, key.p1(), key.p2(), key.p3());
+        return GIT::qHash(key, seed);
     }
 };
 
@@ -10,14 +10,21 @@
 #define REPOSITORY_H
 #include <QString>
 #include <QTimer>
+#include <QFuture>
 #include <git2.h>
 #include <git2qt/branchcollection.h>
 #include <git2qt/tagcollection.h>
 #include <git2qt/gitentity.h>
 #include <git2qt/branch.h>
 #include <git2qt/diffdelta.h>
+#include <git2qt/lazydiff.h>
 #include <git2qt/commit.h>
+#include <git2qt/commitcache.h>
+#include <git2qt/diffcache.h>
+#include <git2qt/committable.h>
 #include <git2qt/graphedcommit.h>
+#include <git2qt/graphlayout.h>
+#include <git2qt/graphbuildstatistics.h>
 #include <git2qt/commitoptions.h>
 #include <git2qt/reference.h>
 #include <git2qt/remote.h>
@@ -42,6 +49,7 @@ namespace GIT {
 class AnnotatedCommitHandle;
 class AnnotatedTag;
 class BranchCollection;
+class CommitGraphFile;
 class CompareOptions;
 class Configuration;
 class AbstractCredentialResolver;
@@ -117,6 +125,7 @@ public:
     Commit initialCommit();
     Commit mostRecentCommit();
     int commitDistance(const Commit& a, const Commit& b);
+    CommitTable commitTable(const CommitFilter& filter, bool includeMessages = false);
 
     // Blobs
     Blob findBlob(const ObjectId& objectId);
@@ -161,9 +170,12 @@ public:
 
     // Diffs
     DiffDelta::List diffTreeToTree(const Tree& oldTree, const Tree& newTree, const CompareOptions& compareOptions, DiffModifiers diffFlags = DiffModifier::DiffModNone) const;
+    DiffDelta::List diffTreeToTreeParallel(const Tree& oldTree, const Tree& newTree, const CompareOptions& compareOptions, DiffModifiers diffFlags = DiffModifier::DiffModNone, int threadCount = 0) const;
     DiffDelta::List diffIndexToWorkDir(const QString& path, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags = DiffModifier::DiffModNone) const;
     DiffDelta::List diffIndexToWorkDir(const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags = DiffModifier::DiffModNone) const;
     DiffDelta::List diffTreeToWorkDir(const Tree& oldTree, const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags = DiffModifier::DiffModNone) const;
+    LazyDiff lazyDiffTreeToTree(const Tree& oldTree, const Tree& newTree, const CompareOptions& compareOptions, DiffModifiers diffFlags = DiffModifier::DiffModNone) const;
+    LazyDiff lazyDiffIndexToWorkDir(const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags = DiffModifier::DiffModNone) const;
     DiffDelta diffDelta(const StatusEntry& statusEntry) const;
     DiffDelta::List diffDeltas(const StatusEntry::List& statusEntries) const;
 
@@ -179,8 +191,29 @@ public:
 
     // Graph
     GraphedCommit::List commitGraph();
+    GraphedCommit::List commitGraph(const GraphedCommit::List& previous);
+    GraphedCommit::List commitGraph(GraphLayout& layout);
+    GraphedCommit::List commitGraph(const QStringList& paths);
+    GraphedCommit::List commitGraph(GraphBuildStatistics& statistics);
+    GraphedCommit::List collapsedCommitGraph();
+    GraphedCommit::List expandCollapsedMerge(const ObjectId& mergeCommitId);
+    QFuture<GraphedCommit::List> commitGraphAsync(int previewCount = DefaultGraphPreviewCount);
+    void cancelCommitGraph();
+
+    // Keep calculated graphs in the git directory and start from them next time
+    bool useGraphLayoutCache() const { return _useGraphLayoutCache; }
+    void setUseGraphLayoutCache(bool value) { _useGraphLayoutCache = value; }
+
+    // Commit-graph maintenance
+    bool updateCommitGraph(bool force = false);
+    bool isCommitGraphStale() const;
+    bool autoUpdateCommitGraph() const { return _autoUpdateCommitGraph; }
+    void setAutoUpdateCommitGraph(bool value) { _autoUpdateCommitGraph = value; }
 
     ObjectDatabase* objectDatabase() const { return _objectDatabase; }
+    CommitCache* commitCache() const { return _commitCache; }
+    DiffCache* diffCache() const { return _diffCache; }
+    const CommitGraphFile* commitGraphFile() const { return _commitGraphFile; }
 
     // Credentials Callback
     void setCredentialResolver(AbstractCredentialResolver* value) { _credentialResolver = value; }
@@ -213,6 +246,8 @@ public:
 
     virtual bool isNull() const override { return _handle.isNull(); }
 
+    static const int DefaultGraphPreviewCount = 200;
+
 private:
     class BenchMark
     {
@@ -247,6 +282,9 @@ private:
 
     QString _localPath;
     bool _bare = false;
+    bool _autoUpdateCommitGraph = false;
+    bool _useGraphLayoutCache = false;
+    QFuture<GraphedCommit::List> _commitGraphFuture;
 
     RepositoryHandle _handle;
     git_remote *_remote = nullptr;
@@ -255,6 +293,9 @@ private:
     RepositoryInformation* _info = nullptr;
     Configuration* _config = nullptr;
     ObjectDatabase* _objectDatabase = nullptr;
+    CommitCache* _commitCache = nullptr;
+    DiffCache* _diffCache = nullptr;
+    CommitGraphFile* _commitGraphFile = nullptr;
     ReferenceCollection* _references = nullptr;
     Network* _network = nullptr;
     SubmoduleCollection* _submodules = nullptr;
@@ -26,6 +26,11 @@ public:
     Commit base() const;
     Commit index() const;
     Commit untracked() const;
+
+    // The parents of the stash commit, without looking them up
+    ObjectId baseId() const { return _targetObject.parentIds().value(0); }
+    ObjectId indexId() const { return _targetObject.parentIds().value(1); }
+    ObjectId untrackedId() const { return _targetObject.parentIds().value(2); }
     QString message() const { return _message; }
 
     bool isValid() const { return isNull() == false; }
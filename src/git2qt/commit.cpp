@@ -3,6 +3,8 @@
 #include <repository.h>
 #include <objectid.h>
 #include <tree.h>
+#include <git2qt/private/commitdetails.h>
+#include <git2qt/private/commitgraphfile.h>
 
 using namespace GIT;
 
@@ -28,19 +30,54 @@ Commit::Commit(GitEntityType entityType, Repository* repo, const ObjectId& objec
     resolve();
 }
 
+Commit::Commit(GitEntityType entityType, const Commit& other) :
+    GitObject(entityType, other.repository(), other.objectId()),
+    _treeId(other._treeId),
+    _parentIds(other._parentIds),
+    _timestamp(other._timestamp),
+    _details(other._details)
+{
+}
+
 void Commit::resolve()
 {
-    CommitHandle handle = createHandle();
-    if(handle.isNull() == false) {
-        _author = Signature(git_commit_author(handle.value()));
-        _committer = Signature(git_commit_committer(handle.value()));
-        _message = git_commit_message(handle.value());
-        _shortMessage = git_commit_summary(handle.value());
-        _encoding = git_commit_message_encoding(handle.value());
-        _timestamp = QDateTime::fromSecsSinceEpoch((int64_t)git_commit_time(handle.value()), Qt::UTC);
+    CommitCache::Entry entry;
+    QSharedPointer<CommitDetails> details;
+    if(findHeader(repository(), objectId(), entry, details)) {
+        resolveHeader(entry, details);
+    }
+}
+
+// details are only known when findHeader() had to look the commit up; otherwise
+// they are read from the object database when first asked for
+void Commit::resolveHeader(const CommitCache::Entry& entry, const QSharedPointer<CommitDetails>& details)
+{
+    _treeId = entry.treeId();
+    _parentIds = entry.parentIds();
+    _timestamp = QDateTime::fromSecsSinceEpoch(entry.committerTime(), Qt::UTC);
+    _details = details;
+
+    git_odb* odb = nullptr;
+    if(_details.isNull() && repository() != nullptr && git_repository_odb(&odb, repository()->handle().value()) == 0) {
+        _details = QSharedPointer<CommitDetails>(new CommitDetails(odb, objectId()));
+        if(entry.hasSummary()) {
+            _details->setShortMessage(entry.summary());
+        }
     }
 }
 
+// Copies share their details, so take our own before changing any of them
+void Commit::detachDetails()
+{
+    QSharedPointer<CommitDetails> details(new CommitDetails());
+    details->setAuthor(author());
+    details->setCommitter(committer());
+    details->setMessage(message());
+    details->setShortMessage(shortMessage());
+    details->setEncoding(encoding());
+    _details = details;
+}
+
 Commit::~Commit()
 {
 }
@@ -54,25 +91,79 @@ bool Commit::operator ==(const Commit& other) const
 Commit Commit::lookup(Repository* repo, const ObjectId& objectId)
 {
     Commit result;
-    git_commit *commit;
-    if(git_commit_lookup(&commit, repo->handle().value(), objectId.toNative()) == 0) {
-        result = createFromNative(repo, commit);
-        git_commit_free(commit);
+    CommitCache::Entry entry;
+    QSharedPointer<CommitDetails> details;
+    if(findHeader(repo, objectId, entry, details)) {
+        result = Commit(repo);
+        result.setObjectId(objectId);
+        result.resolveHeader(entry, details);
     }
     return result;
 }
 
-ObjectId Commit::treeId() const
+Commit Commit::fromHeader(Repository* repo, const ObjectId& objectId, const CommitCache::Entry& entry)
 {
-    ObjectId result;
-    git_commit *thisCommit = nullptr;
-    if(git_commit_lookup(&thisCommit, repository()->handle().value(), objectId().toNative()) == 0) {
-        const git_oid* oid = git_commit_tree_id(thisCommit);
-        result = ObjectId(oid);
-    }
+    Commit result(repo);
+    result.setObjectId(objectId);
+    result.resolveHeader(entry, QSharedPointer<CommitDetails>());
     return result;
 }
 
+Signature Commit::author() const
+{
+    return _details.isNull() ? Signature() : _details->author();
+}
+
+void Commit::setAuthor(const Signature& value)
+{
+    detachDetails();
+    _details->setAuthor(value);
+}
+
+Signature Commit::committer() const
+{
+    return _details.isNull() ? Signature() : _details->committer();
+}
+
+void Commit::setCommitter(const Signature& value)
+{
+    detachDetails();
+    _details->setCommitter(value);
+}
+
+QString Commit::message() const
+{
+    return _details.isNull() ? QString() : _details->message();
+}
+
+void Commit::setMessage(const QString& value)
+{
+    detachDetails();
+    _details->setMessage(value);
+}
+
+QString Commit::shortMessage() const
+{
+    return _details.isNull() ? QString() : _details->shortMessage();
+}
+
+void Commit::setShortMessage(const QString& value)
+{
+    detachDetails();
+    _details->setShortMessage(value);
+}
+
+QString Commit::encoding() const
+{
+    return _details.isNull() ? QString() : _details->encoding();
+}
+
+void Commit::setEncoding(const QString& value)
+{
+    detachDetails();
+    _details->setEncoding(value);
+}
+
 Tree Commit::tree() const
 {
     return repository()->lookupTree(treeId());
@@ -98,18 +189,11 @@ bool Commit::isReachableFromAny(const List& other) const
 Commit::List Commit::parents() const
 {
     Commit::List result;
-
-    git_commit *thisCommit;
-    if(git_commit_lookup(&thisCommit, repository()->handle().value(), objectId().toNative()) == 0) {
-        int count = git_commit_parentcount(thisCommit);
-        for (int i = 0;i < count;i++) {
-            git_commit *parent;
-            git_commit_parent(&parent, thisCommit, i);
-            Commit commit = createFromNative(repository(), parent);
+    for(const ObjectId& parentId : _parentIds) {
+        Commit commit = Commit::lookup(repository(), parentId);
+        if(commit.isValid()) {
             result.append(commit);
-            git_commit_free(parent);
         }
-        git_commit_free(thisCommit);
     }
     return result;
 }
@@ -124,9 +208,34 @@ CommitHandle Commit::createHandle() const
     return handle;
 }
 
-Commit Commit::createFromNative(Repository* repo, git_commit* commit)
+bool Commit::findHeader(Repository* repo, const ObjectId& objectId, CommitCache::Entry& entry, QSharedPointer<CommitDetails>& details)
 {
-    ObjectId objectId = git_commit_id(commit);
-    Commit result(repo, objectId);
-    return result;
+    if(repo == nullptr || objectId.isNull()) {
+        return false;
+    }
+
+    CommitCache* cache = repo->commitCache();
+    if(cache != nullptr && cache->find(objectId, entry)) {
+        return true;
+    }
+
+    // the commit-graph file gives us the header without inflating the commit
+    const CommitGraphFile* graphFile = repo->commitGraphFile();
+    int position;
+    if(graphFile != nullptr && (position = graphFile->positionOf(objectId)) >= 0) {
+        entry = CommitCache::Entry(graphFile->treeIdAt(position), graphFile->parentIdsAt(position), graphFile->commitTimeAt(position));
+        if(cache != nullptr) {
+            cache->insert(objectId, entry);
+        }
+        return true;
+    }
+
+    git_commit* commit = nullptr;
+    if(git_commit_lookup(&commit, repo->handle().value(), objectId.toNative()) != 0) {
+        return false;
+    }
+    entry = cache != nullptr ? cache->insert(objectId, commit) : CommitCache::Entry(commit);
+    details = QSharedPointer<CommitDetails>(new CommitDetails(commit));
+    git_commit_free(commit);
+    return true;
 }
@@ -0,0 +1,125 @@
+#include "commitcache.h"
+
+#include <repository.h>
+
+using namespace GIT;
+
+CommitCache::Entry::Entry(const git_commit* commit)
+{
+    _treeId = ObjectId(git_commit_tree_id(commit));
+    unsigned int count = git_commit_parentcount(commit);
+    _parentIds.reserve(count);
+    for(unsigned int i = 0;i < count;i++) {
+        _parentIds.append(ObjectId(git_commit_parent_id(commit, i)));
+    }
+    const git_signature* author = git_commit_author(commit);
+    if(author != nullptr) {
+        _authorTime = author->when.time;
+    }
+    _committerTime = git_commit_time(commit);
+    // git_commit_summary() takes a non-const commit since it caches the result internally
+    _summary = git_commit_summary(const_cast<git_commit*>(commit));
+    _hasSummary = true;
+}
+
+qsizetype CommitCache::Entry::cost() const
+{
+    return sizeof(Entry) +
+           _parentIds.count() * sizeof(ObjectId) +
+           _summary.size() * sizeof(QChar);
+}
+
+CommitCache::CommitCache(Repository* repo) :
+    QObject(),
+    GitEntity(CommitCacheEntity, repo)
+{
+    _cache.setMaxCost(DefaultMaxMemory);
+}
+
+bool CommitCache::find(const ObjectId& objectId, Entry& entry)
+{
+    QMutexLocker lock(&_mutex);
+    const Entry* found = _cache.object(objectId);
+    if(found == nullptr) {
+        _misses++;
+        return false;
+    }
+    _hits++;
+    entry = *found;
+    return true;
+}
+
+CommitCache::Entry CommitCache::insert(const ObjectId& objectId, const git_commit* commit)
+{
+    Entry entry(commit);
+    insert(objectId, entry);
+    return entry;
+}
+
+void CommitCache::insert(const ObjectId& objectId, const Entry& entry)
+{
+    QMutexLocker lock(&_mutex);
+    _cache.insert(objectId, new Entry(entry), entry.cost());
+}
+
+bool CommitCache::contains(const ObjectId& objectId) const
+{
+    QMutexLocker lock(&_mutex);
+    return _cache.contains(objectId);
+}
+
+qsizetype CommitCache::maxMemory() const
+{
+    QMutexLocker lock(&_mutex);
+    return _cache.maxCost();
+}
+
+void CommitCache::setMaxMemory(qsizetype bytes)
+{
+    QMutexLocker lock(&_mutex);
+    _cache.setMaxCost(bytes);
+}
+
+qsizetype CommitCache::memoryUsed() const
+{
+    QMutexLocker lock(&_mutex);
+    return _cache.totalCost();
+}
+
+int CommitCache::count() const
+{
+    QMutexLocker lock(&_mutex);
+    return _cache.count();
+}
+
+quint64 CommitCache::hits() const
+{
+    QMutexLocker lock(&_mutex);
+    return _hits;
+}
+
+quint64 CommitCache::misses() const
+{
+    QMutexLocker lock(&_mutex);
+    return _misses;
+}
+
+double CommitCache::hitRate() const
+{
+    QMutexLocker lock(&_mutex);
+    quint64 total = _hits + _misses;
+    return total > 0 ? (double)_hits / (double)total : 0;
+}
+
+void CommitCache::resetStatistics()
+{
+    QMutexLocker lock(&_mutex);
+    _hits = 0;
+    _misses = 0;
+}
+
+void CommitCache::clear()
+{
+    QMutexLocker lock(&_mutex);
+    _cache.clear();
+}
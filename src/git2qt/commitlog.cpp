@@ -3,83 +3,175 @@
 #include <gitexception.h>
 #include <repository.h>
 #include <utility.h>
+#include <git2qt/private/historysimplifier.h>
+
+#include <limits>
 
 using namespace GIT;
 
 CommitLog::CommitLog(Repository* repo, const CommitFilter& filter) :
     GitEntity(CommitLogEntity, repo),
-    _filter(filter)
+    _filter(filter),
+    _maxResults(filter.maxResults())
 {
 
 }
 
+CommitLog::~CommitLog()
+{
+    close();
+}
+
 Commit::List CommitLog::performLookup()
 {
     Commit::List commits;
-    RevWalkHandle handle = createWalkerHandle();
+
+    // path limiting simplifies the whole walk, and maxResults applies to what survives it
+    bool simplify = _filter.paths().isEmpty() == false;
+    _maxResults = simplify ? 0 : _filter.maxResults();
+    if(open()) {
+        commits = fetchNext(std::numeric_limits<int>::max());
+        if(_walkFailed) {
+            commits.clear();
+        }
+        else if(simplify) {
+            commits = HistorySimplifier(repository(), _filter.paths()).simplify(commits, _filter.includeReachableFromRefs());
+            if(_filter.maxResults() > 0 && commits.count() > _filter.maxResults()) {
+                commits.erase(commits.begin() + _filter.maxResults(), commits.end());
+            }
+        }
+    }
+    close();
+    _maxResults = _filter.maxResults();
+    return commits;
+}
+
+void CommitLog::findReachableFrom(const Commit& commit)
+{
+    Q_UNUSED(commit)
+}
+
+bool CommitLog::open(int offset)
+{
+    bool result = false;
+
+    close();
+    _walker = createWalkerHandle();
     try
     {
-        throwIfTrue(handle.isNull());
-        throwOnError(git_revwalk_sorting(handle.value(), _filter.sortBy()));
+        throwIfTrue(_walker.isNull());
+        throwOnError(git_revwalk_sorting(_walker.value(), _filter.sortBy()));
 
         // Include
         ObjectId::List includeObjectIds = _filter.includeReachableFromRefs();
         for(const ObjectId& objectId : includeObjectIds) {
-            throwOnError(git_revwalk_push(handle.value(), objectId.toNative()));
+            throwOnError(git_revwalk_push(_walker.value(), objectId.toNative()));
         }
 
         // Exclude
         ObjectId::List excludeObjectIds = _filter.excludeReachableFromRefs();
         for(const ObjectId& objectId : excludeObjectIds) {
-            throwOnError(git_revwalk_hide(handle.value(), objectId.toNative()));
+            throwOnError(git_revwalk_hide(_walker.value(), objectId.toNative()));
         }
 
         // First parent only
         if(_filter.firstParentOnly()) {
-            throwOnError(git_revwalk_simplify_first_parent(handle.value()));
-        }
-
-        ObjectId::List foundObjectIds;
-        ObjectId::Set foundObjectIdSet; // for fast lookup of stopWhenFound
-        git_oid oid;
-        int res;
-        while((res = git_revwalk_next(&oid, handle.value())) == 0) {
-            foundObjectIds.append(oid);
-            foundObjectIdSet.insert(oid);
-            if(_filter.maxResults() > 0 && foundObjectIds.count() >= _filter.maxResults()) {
-                break;
-            }
-
-            if(_filter.stopWhenFound().count() > 0) {
-                if(foundObjectIdSet.containsAll(_filter.stopWhenFound())) {
-                    break;
-                }
-            }
+            throwOnError(git_revwalk_simplify_first_parent(_walker.value()));
         }
-        throwIfFalse(res == GIT_ITEROVER || res == 0);
 
-        for(const ObjectId& commitId : foundObjectIds) {
-            Commit commit = Commit::lookup(repository(), commitId);
-            if(commit.isNull() == false) {
-                commits.append(commit);
-            }
-            else {
-                logText(LVL_DEBUG, "IT's null");
-            }
-        }
+        _pendingStops = ObjectId::Set(_filter.stopWhenFound());
+        _position = 0;
+        _returned = 0;
+        _atEnd = false;
+        _walkFailed = false;
 
-        handle.dispose();
+        skip(offset);
+        result = true;
     }
     catch(const GitException&)
     {
-        commits.clear();
+        close();
+    }
+    return result;
+}
+
+Commit::List CommitLog::fetchNext(int count)
+{
+    Commit::List commits;
+    ObjectId objectId;
+    while(commits.count() < count && nextObjectId(objectId)) {
+        Commit commit = Commit::lookup(repository(), objectId);
+        if(commit.isNull() == false) {
+            commits.append(commit);
+            _returned++;
+        }
+        else {
+            logText(LVL_DEBUG, "IT's null");
+        }
     }
     return commits;
 }
 
-void CommitLog::findReachableFrom(const Commit& commit)
+ObjectId::List CommitLog::fetchNextObjectIds(int count)
 {
-    Q_UNUSED(commit)
+    ObjectId::List objectIds;
+    ObjectId objectId;
+    while(objectIds.count() < count && nextObjectId(objectId)) {
+        objectIds.append(objectId);
+        _returned++;
+    }
+    return objectIds;
+}
+
+int CommitLog::skip(int count)
+{
+    int skipped = 0;
+    ObjectId objectId;
+    while(skipped < count && nextObjectId(objectId)) {
+        skipped++;
+    }
+    return skipped;
+}
+
+void CommitLog::close()
+{
+    _walker.dispose();
+    _walker = RevWalkHandle();
+    _pendingStops.clear();
+    _atEnd = true;
+}
+
+bool CommitLog::nextObjectId(ObjectId& objectId)
+{
+    if(_atEnd) {
+        return false;
+    }
+
+    // maxResults limits the commits returned, not those skipped
+    if(_maxResults > 0 && _returned >= _maxResults) {
+        _atEnd = true;
+        return false;
+    }
+
+    git_oid oid;
+    int res = git_revwalk_next(&oid, _walker.value());
+    if(res != 0) {
+        _walkFailed = res != GIT_ITEROVER;
+        _atEnd = true;
+        return false;
+    }
+
+    objectId = oid;
+    _position++;
+
+    // stop once every commit in stopWhenFound has been produced
+    if(_pendingStops.count() > 0) {
+        _pendingStops.remove(objectId);
+        if(_pendingStops.count() == 0) {
+            _atEnd = true;
+        }
+    }
+    return true;
 }
 
 RevWalkHandle CommitLog::createWalkerHandle() const
@@ -0,0 +1,139 @@
+#include "committable.h"
+
+#include <commitlog.h>
+#include <gitexception.h>
+#include <repository.h>
+
+using namespace GIT;
+
+CommitTable::CommitTable(Repository* repo) :
+    GitEntity(CommitTableEntity, repo)
+{
+}
+
+bool CommitTable::build(const CommitFilter& filter, bool includeMessages)
+{
+    static const int BatchSize = 1024;
+
+    bool result = false;
+    clear();
+    _hasMessages = includeMessages;
+    _parentOffsets.append(0);
+    _summaryOffsets.append(0);
+    _messageOffsets.append(0);
+
+    CommitLog commitLog(repository(), filter);
+    try
+    {
+        throwIfFalse(commitLog.open(), "Failed to open commit log");
+        while(commitLog.canFetchMore()) {
+            ObjectId::List batch = commitLog.fetchNextObjectIds(BatchSize);
+            for(const ObjectId& objectId : batch) {
+                git_commit* commit = nullptr;
+                throwOnError(git_commit_lookup(&commit, repository()->handle().value(), objectId.toNative()));
+
+                _rows.insert(objectId, _objectIds.count());
+                _objectIds.append(objectId);
+                _commitTimes.append(git_commit_time(commit));
+
+                const git_signature* author = git_commit_author(commit);
+                _authorTimes.append(author != nullptr ? author->when.time : 0);
+                _authorIndexes.append(internAuthor(author));
+
+                unsigned int parentCount = git_commit_parentcount(commit);
+                for(unsigned int i = 0;i < parentCount;i++) {
+                    _parentIds.append(ObjectId(git_commit_parent_id(commit, i)));
+                }
+                _parentOffsets.append(_parentIds.count());
+
+                const char* summary = git_commit_summary(commit);
+                if(summary != nullptr) {
+                    _summaryArena.append(summary);
+                }
+                _summaryOffsets.append(_summaryArena.size());
+
+                if(includeMessages) {
+                    const char* message = git_commit_message(commit);
+                    if(message != nullptr) {
+                        _messageArena.append(message);
+                    }
+                    _messageOffsets.append(_messageArena.size());
+                }
+
+                git_commit_free(commit);
+            }
+        }
+
+        // Parents follow their children in the walk, so rows can only be resolved once it is complete
+        _parentRows.reserve(_parentIds.count());
+        for(const ObjectId& parentId : _parentIds) {
+            _parentRows.append(rowOf(parentId));
+        }
+        result = true;
+    }
+    catch(const GitException&)
+    {
+        clear();
+    }
+    return result;
+}
+
+void CommitTable::clear()
+{
+    _objectIds.clear();
+    _rows.clear();
+    _commitTimes.clear();
+    _authorTimes.clear();
+    _parentOffsets.clear();
+    _parentRows.clear();
+    _parentIds.clear();
+    _authorIndexes.clear();
+    _authorNames.clear();
+    _authorEmails.clear();
+    _authorPool.clear();
+    _summaryArena.clear();
+    _summaryOffsets.clear();
+    _messageArena.clear();
+    _messageOffsets.clear();
+    _hasMessages = false;
+}
+
+ObjectId::List CommitTable::parentIds(int row) const
+{
+    return _parentIds.mid(_parentOffsets.at(row), parentCount(row));
+}
+
+QString CommitTable::summaryAt(int row) const
+{
+    return textAt(_summaryArena, _summaryOffsets, row);
+}
+
+QString CommitTable::messageAt(int row) const
+{
+    return _hasMessages ? textAt(_messageArena, _messageOffsets, row) : QString();
+}
+
+int CommitTable::internAuthor(const git_signature* signature)
+{
+    if(signature == nullptr) {
+        return NoRow;
+    }
+
+    QString name = QString::fromUtf8(signature->name);
+    QString email = QString::fromUtf8(signature->email);
+    QString key = QString("%1 <%2>").arg(name, email);
+    int result = _authorPool.value(key, NoRow);
+    if(result == NoRow) {
+        result = _authorNames.count();
+        _authorNames.append(name);
+        _authorEmails.append(email);
+        _authorPool.insert(key, result);
+    }
+    return result;
+}
+
+QString CommitTable::textAt(const QByteArray& arena, const QVector<int>& offsets, int row)
+{
+    int start = offsets.at(row);
+    return QString::fromUtf8(arena.constData() + start, offsets.at(row + 1) - start);
+}
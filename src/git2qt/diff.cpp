@@ -12,8 +12,13 @@
 #include <gitexception.h>
 #include <tree.h>
 #include <diffoptions.h>
+#include <diffvisitor.h>
+#include <diffcache.h>
 #include "log.h"
 
+#include <QThread>
+#include <QThreadPool>
+
 using namespace GIT;
 
 TreeChanges Diff::compare(DiffModifiers diffModifiers, const QStringList& paths, const CompareOptions& compareOptions)
@@ -48,6 +53,15 @@ TreeChanges Diff::compare(const Tree& fromTree, const Tree& toTree, DiffModifier
 {
     TreeChanges result;
 
+    DiffCache* cache = repository()->diffCache();
+    QByteArray key;
+    if(cache != nullptr) {
+        key = DiffCache::changesKey(fromTree.objectId(), toTree.objectId(), buildDiffOptions(diffOptions, QStringList(), compareOptions));
+        if(cache->findChanges(key, result)) {
+            return result;
+        }
+    }
+
     TreeHandle fromHandle = fromTree.createTreeHandle();
     TreeHandle toHandle = toTree.createTreeHandle();
     DiffHandle diffHandle;
@@ -64,6 +78,9 @@ TreeChanges Diff::compare(const Tree& fromTree, const Tree& toTree, DiffModifier
 
         diffHandle = DiffHandle(diff);
         result = buildTreeChanges(diffHandle);
+        if(cache != nullptr) {
+            cache->insertChanges(key, result);
+        }
     }
     catch(const GitException&)
     {
@@ -98,10 +115,179 @@ DiffDelta::List Diff::diffIndexToWorkDir(const QString& path, bool includeUntrac
 DiffDelta::List Diff::diffIndexToWorkDir(const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags) const
 {
     DiffDelta::List collection;
+    DiffHandle diffHandle = createIndexToWorkDirDiff(paths, includeUntracked, compareOptions, diffFlags);
+    if(diffHandle.isNull() == false) {
+        collection = loadDiffs(diffHandle, compareOptions);
+        diffHandle.dispose();
+    }
+    return collection;
+}
+
+bool Diff::diffIndexToWorkDir(const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffVisitor* visitor, DiffModifiers diffFlags) const
+{
+    bool result = false;
+    DiffHandle diffHandle = createIndexToWorkDirDiff(paths, includeUntracked, compareOptions, diffFlags);
+    if(diffHandle.isNull() == false) {
+        result = visitDiffs(diffHandle, compareOptions, visitor);
+        diffHandle.dispose();
+    }
+    return result;
+}
+
+DiffDelta::List Diff::diffTreeToWorkDir(const Tree& oldTree, const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags) const
+{
+    DiffDelta::List collection;
+    DiffHandle diffHandle = createTreeToWorkDirDiff(oldTree, paths, includeUntracked, compareOptions, diffFlags);
+    if(diffHandle.isNull() == false) {
+        collection = loadDiffs(diffHandle, compareOptions);
+        diffHandle.dispose();
+    }
+    return collection;
+}
+
+bool Diff::diffTreeToWorkDir(const Tree& oldTree, const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffVisitor* visitor, DiffModifiers diffFlags) const
+{
+    bool result = false;
+    DiffHandle diffHandle = createTreeToWorkDirDiff(oldTree, paths, includeUntracked, compareOptions, diffFlags);
+    if(diffHandle.isNull() == false) {
+        result = visitDiffs(diffHandle, compareOptions, visitor);
+        diffHandle.dispose();
+    }
+    return result;
+}
+
+DiffDelta::List Diff::diffTreeToTree(const Tree& oldTree, const Tree& newTree, const CompareOptions& compareOptions, DiffModifiers diffFlags) const
+{
+    DiffDelta::List collection;
+
+    DiffCache* cache = repository()->diffCache();
+    QByteArray key;
+    if(cache != nullptr) {
+        key = DiffCache::deltasKey(oldTree.objectId(), newTree.objectId(), buildDiffOptions(diffFlags, QStringList(), compareOptions), compareOptions,
+                                   configuredRenameDetection(compareOptions));
+        if(cache->findDeltas(key, collection)) {
+            return collection;
+        }
+    }
+
+    DiffHandle diffHandle = createTreeToTreeDiff(oldTree, newTree, compareOptions, diffFlags);
+    if(diffHandle.isNull() == false) {
+        collection = loadDiffs(diffHandle, compareOptions);
+        diffHandle.dispose();
+        if(cache != nullptr) {
+            cache->insertDeltas(key, collection);
+        }
+    }
+    return collection;
+}
+
+/**
+ * Generate the patches of a tree to tree diff on several threads.
+ *
+ * The trees are compared and renames detected once, on the calling thread.
+ * Workers then claim the files one at a time from a shared counter, so a
+ * few large files do not hold up one worker while the others sit idle, and
+ * patch each from its blob ids, paths and modes with git_patch_from_blobs()
+ * on a repository handle of their own, since libgit2 objects must not be shared
+ * between threads. The result matches diffTreeToTree() except that binary
+ * files carry no DiffBinary.
+ *
+ * Files a worker could not patch are patched afterwards on the calling thread.
+ *
+ * A threadCount of 0 uses QThread::idealThreadCount().
+ */
+DiffDelta::List Diff::diffTreeToTreeParallel(const Tree& oldTree, const Tree& newTree, const CompareOptions& compareOptions, DiffModifiers diffFlags, int threadCount) const
+{
+    DiffDelta::List collection;
+    DiffHandle diffHandle = createTreeToTreeDiff(oldTree, newTree, compareOptions, diffFlags);
+    if(diffHandle.isNull()) {
+        return collection;
+    }
+
+    int count = git_diff_num_deltas(diffHandle.value());
+    if(threadCount <= 0) {
+        threadCount = QThread::idealThreadCount();
+    }
+    threadCount = qMin(threadCount, count);
+
+    if(threadCount < 2 || (git_libgit2_features() & GIT_FEATURE_THREADS) == 0) {
+        collection = loadDiffs(diffHandle, compareOptions);
+        diffHandle.dispose();
+        return collection;
+    }
+
+    // renames are detected before the files are handed out
+    LazyDiff lazyDiff = createLazyDiff(diffHandle, compareOptions);
+    count = lazyDiff.count();
+    QVector<BlobPair> blobPairs;
+    blobPairs.reserve(count);
+    for(int index = 0;index < count;index++) {
+        blobPairs.append(BlobPair(git_diff_get_delta(diffHandle.value(), index)));
+    }
+
+    // every worker writes only its own elements
+    collection = lazyDiff.deltas();
+    DiffDelta* deltas = collection.data();
+    QVector<bool> patched(count, false);
+    bool* patchedData = patched.data();
+    QByteArray repoPath = git_repository_path(repository()->handle().value());
+
+    QAtomicInt next(0);
+    QThreadPool pool;
+    pool.setMaxThreadCount(threadCount);
+    for(int worker = 0;worker < threadCount;worker++) {
+        pool.start([this, &repoPath, &blobPairs, &compareOptions, diffFlags, &next, deltas, patchedData]()
+        {
+            loadPatches(repoPath, blobPairs, compareOptions, diffFlags, &next, deltas, patchedData);
+        });
+    }
+    pool.waitForDone();
+
+    int failed = 0;
+    for(int index = 0;index < count;index++) {
+        if(patched.at(index) == false && blobPairs.at(index).hasPatch()) {
+            collection[index] = lazyDiff.patch(index);
+            failed++;
+        }
+    }
+    if(failed > 0) {
+        Log::logText(LVL_WARNING, QString("Parallel diff could not patch %1 of %2 files, patched them serially").arg(failed).arg(count));
+    }
+    return collection;
+}
+
+bool Diff::diffTreeToTree(const Tree& oldTree, const Tree& newTree, const CompareOptions& compareOptions, DiffVisitor* visitor, DiffModifiers diffFlags) const
+{
+    bool result = false;
+    DiffHandle diffHandle = createTreeToTreeDiff(oldTree, newTree, compareOptions, diffFlags);
+    if(diffHandle.isNull() == false) {
+        result = visitDiffs(diffHandle, compareOptions, visitor);
+        diffHandle.dispose();
+    }
+    return result;
+}
+
+LazyDiff Diff::lazyDiffIndexToWorkDir(const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags) const
+{
+    return createLazyDiff(createIndexToWorkDirDiff(paths, includeUntracked, compareOptions, diffFlags), compareOptions);
+}
+
+LazyDiff Diff::lazyDiffTreeToWorkDir(const Tree& oldTree, const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags) const
+{
+    return createLazyDiff(createTreeToWorkDirDiff(oldTree, paths, includeUntracked, compareOptions, diffFlags), compareOptions);
+}
+
+LazyDiff Diff::lazyDiffTreeToTree(const Tree& oldTree, const Tree& newTree, const CompareOptions& compareOptions, DiffModifiers diffFlags) const
+{
+    return createLazyDiff(createTreeToTreeDiff(oldTree, newTree, compareOptions, diffFlags), compareOptions);
+}
+
+DiffHandle Diff::createIndexToWorkDirDiff(const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags) const
+{
+    DiffHandle result;
     git_diff* diff = nullptr;
 
     IndexHandle indexHandle = repository()->index()->createHandle();
-    DiffHandle diffHandle;
     try
     {
         if(includeUntracked) {
@@ -114,27 +300,24 @@ DiffDelta::List Diff::diffIndexToWorkDir(const QStringList& paths, bool includeU
 
         throwOnError(git_diff_index_to_workdir(&diff, repository()->handle().value(), indexHandle.value(), options.toNative()));
 
-        diffHandle = DiffHandle(diff);
-        collection = loadDiffs(diffHandle, compareOptions);
+        result = DiffHandle(diff);
     }
     catch(const GitException&)
     {
     }
 
-    diffHandle.dispose();
     indexHandle.dispose();
 
-    return collection;
+    return result;
 }
 
-DiffDelta::List Diff::diffTreeToWorkDir(const Tree& oldTree, const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags) const
+DiffHandle Diff::createTreeToWorkDirDiff(const Tree& oldTree, const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags) const
 {
-    DiffDelta::List collection;
+    DiffHandle result;
     git_diff* diff = nullptr;
 
     IndexHandle indexHandle = repository()->index()->createHandle();
     TreeHandle oldTreeHandle = oldTree.createTreeHandle();
-    DiffHandle diffHandle;
     try
     {
         if(includeUntracked) {
@@ -148,29 +331,26 @@ DiffDelta::List Diff::diffTreeToWorkDir(const Tree& oldTree, const QStringList&
 
         throwOnError(git_diff_tree_to_workdir(&diff, repository()->handle().value(), oldTreeHandle.value(), options.toNative()));
 
-        diffHandle = DiffHandle(diff);
-        collection = loadDiffs(diffHandle, compareOptions);
+        result = DiffHandle(diff);
     }
     catch(const GitException&)
     {
     }
 
-    diffHandle.dispose();
     indexHandle.dispose();
     oldTreeHandle.dispose();
 
-    return collection;
+    return result;
 }
 
-DiffDelta::List Diff::diffTreeToTree(const Tree& oldTree, const Tree& newTree, const CompareOptions& compareOptions, DiffModifiers diffFlags) const
+DiffHandle Diff::createTreeToTreeDiff(const Tree& oldTree, const Tree& newTree, const CompareOptions& compareOptions, DiffModifiers diffFlags) const
 {
-    DiffDelta::List collection;
+    DiffHandle result;
     git_diff* diff = nullptr;
 
     IndexHandle indexHandle = repository()->index()->createHandle();
     TreeHandle oldTreeHandle = oldTree.createTreeHandle();
     TreeHandle newTreeHandle = newTree.createTreeHandle();
-    DiffHandle diffHandle;
 
     try
     {
@@ -182,28 +362,97 @@ DiffDelta::List Diff::diffTreeToTree(const Tree& oldTree, const Tree& newTree, c
 
         throwOnError(git_diff_tree_to_tree(&diff, repository()->handle().value(), oldTreeHandle.value(), newTreeHandle.value(), options.toNative()));
 
-        diffHandle = DiffHandle(diff);
-        collection = loadDiffs(diffHandle, compareOptions);
+        result = DiffHandle(diff);
     }
     catch(const GitException&)
     {
     }
 
-    diffHandle.dispose();
     indexHandle.dispose();
-    return collection;
+    return result;
 }
 
 DiffDelta::List Diff::loadDiffs(const DiffHandle& handle, const CompareOptions& compareOptions) const
 {
-    DiffDelta::List collection;
+    DeltaCollector collector;
     detectRenames(handle, compareOptions);
 
     int count = git_diff_num_deltas(handle.value());
     if(count > 0) {
-        git_diff_foreach(handle.value(), fileCallback, binaryCallback, hunkCallback, lineCallback, &collection);
+        git_diff_foreach(handle.value(), fileCallback, binaryCallback, hunkCallback, lineCallback, &collector);
     }
-    return collection;
+    return collector.takeDeltas();
+}
+
+/**
+ * Drive a visitor from git_diff_foreach(). Answers false when the diff
+ * failed or the visitor stopped it.
+ */
+bool Diff::visitDiffs(const DiffHandle& handle, const CompareOptions& compareOptions, DiffVisitor* visitor) const
+{
+    detectRenames(handle, compareOptions);
+    return git_diff_foreach(handle.value(), visitFileCallback, visitBinaryCallback, visitHunkCallback, visitLineCallback, visitor) == 0;
+}
+
+/**
+ * Worker of diffTreeToTreeParallel(). Claims indexes from next until all
+ * are taken, adds the hunks and line statistics of each blob pair to the
+ * matching delta and marks it patched. Nothing here may touch the shared
+ * Repository, so errors simply leave a file unpatched.
+ */
+void Diff::loadPatches(const QByteArray& repoPath, const QVector<BlobPair>& blobPairs, const CompareOptions& compareOptions, DiffModifiers diffFlags,
+                       QAtomicInt* next, DiffDelta* deltas, bool* patched) const
+{
+    git_repository* repo = nullptr;
+    if(git_repository_open(&repo, repoPath.constData()) != 0) {
+        return;
+    }
+
+    // the options of the calling thread's diff, so that contexts match
+    DiffOptions options = buildDiffOptions(diffFlags, QStringList(), compareOptions);
+    for(int index = next->fetchAndAddRelaxed(1);index < blobPairs.count();index = next->fetchAndAddRelaxed(1)) {
+        const BlobPair& blobPair = blobPairs.at(index);
+        if(blobPair.hasPatch() == false) {
+            continue;
+        }
+
+        // an added or deleted file has no blob on one side
+        git_blob* oldBlob = nullptr;
+        git_blob* newBlob = nullptr;
+        git_patch* patch = nullptr;
+        if((blobPair.oldId().isNull() || git_blob_lookup(&oldBlob, repo, blobPair.oldId().toNative()) == 0) &&
+           (blobPair.newId().isNull() || git_blob_lookup(&newBlob, repo, blobPair.newId().toNative()) == 0) &&
+           git_patch_from_blobs(&patch, oldBlob, blobPair.oldPath().constData(), newBlob, blobPair.newPath().constData(), options.toNative()) == 0 &&
+           patch != nullptr) {
+            // status, paths and modes stay those of the tree diff, only the binary flags come from the content
+            DiffDelta& delta = deltas[index];
+            DiffDeltaFlags binaryFlags = (DiffDeltaFlag)(git_patch_get_delta(patch)->flags & (GIT_DIFF_FLAG_BINARY | GIT_DIFF_FLAG_NOT_BINARY));
+            delta.setFlags(delta.flags() | binaryFlags);
+            LazyDiff::loadLineStats(patch, delta);
+            LazyDiff::loadHunks(patch, delta);
+            patched[index] = true;
+        }
+
+        git_patch_free(patch);
+        git_blob_free(newBlob);
+        git_blob_free(oldBlob);
+    }
+
+    git_repository_free(repo);
+}
+
+/**
+ * The LazyDiff takes ownership of the handle. Renames are detected up front
+ * so that the deltas it lists never change.
+ */
+LazyDiff Diff::createLazyDiff(const DiffHandle& handle, const CompareOptions& compareOptions) const
+{
+    LazyDiff result;
+    if(handle.isNull() == false) {
+        detectRenames(handle, compareOptions);
+        result = LazyDiff(handle.value());
+    }
+    return result;
 }
 
 DiffOptions Diff::buildDiffOptions(DiffModifiers diffOptions, const QStringList& paths, const CompareOptions& compareOptions) const
@@ -272,6 +521,32 @@ DiffHandle Diff::buildDiffList(const ObjectId& oldTreeId, DiffModifiers diffOpti
     return result;
 }
 
+/**
+ * Given no options, git_diff_find_similar() follows the diff.renames and
+ * diff.renameLimit settings. They are read afresh from a config snapshot
+ * so that a cached diff is never answered after either of them changed.
+ * Empty unless the rename detection is RenameDetectionDefault.
+ */
+QByteArray Diff::configuredRenameDetection(const CompareOptions& compareOptions) const
+{
+    QByteArray result;
+    git_config* config = nullptr;
+    if(compareOptions.similarity().renameDetectionMode() == SimilarityOptions::RenameDetectionDefault &&
+       git_repository_config_snapshot(&config, repository()->handle().value()) == 0) {
+        const char* renames = nullptr;
+        int32_t renameLimit = 0;
+        if(git_config_get_string(&renames, config, "diff.renames") == 0) {
+            result.append(renames);
+        }
+        result.append('\n');
+        if(git_config_get_int32(&renameLimit, config, "diff.renameLimit") == 0) {
+            result.append(QByteArray::number(renameLimit));
+        }
+        git_config_free(config);
+    }
+    return result;
+}
+
 void Diff::detectRenames(const DiffHandle& handle, const CompareOptions& compareOptions) const
 {
     SimilarityOptions similarityOptions = compareOptions.similarity();
@@ -307,15 +582,15 @@ TreeChanges Diff::buildTreeChanges(const DiffHandle& handle)
 int Diff::fileCallback(const git_diff_delta* delta, float progress, void* payload)
 {
     Q_UNUSED(progress)
-    DiffDelta::List* collection = static_cast<DiffDelta::List*>(payload);
-    collection->append(DiffDelta(delta));
+    DeltaCollector* collector = static_cast<DeltaCollector*>(payload);
+    collector->appendDelta(delta);
     return 0;
 }
 
 int Diff::binaryCallback(const git_diff_delta* d, const git_diff_binary* binary, void* payload)
 {
-    DiffDelta::List* collection = static_cast<DiffDelta::List*>(payload);
-    DiffDelta* delta = collection->getDiffDeltaPtr(DiffDelta(d));
+    DeltaCollector* collector = static_cast<DeltaCollector*>(payload);
+    DiffDelta* delta = collector->deltaFor(d);
     if(delta != nullptr) {
         delta->appendBinary(DiffBinary(binary));
     }
@@ -327,12 +602,8 @@ int Diff::binaryCallback(const git_diff_delta* d, const git_diff_binary* binary,
 
 int Diff::hunkCallback(const git_diff_delta* d, const git_diff_hunk* h, void* payload)
 {
-    DiffDelta::List* collection = static_cast<DiffDelta::List*>(payload);
-    DiffDelta* xdelta = collection->getDiffDeltaPtr(DiffDelta(d));
-    if(xdelta != nullptr) {
-        xdelta->appendHunk(DiffHunk(h));
-    }
-    else {
+    DeltaCollector* collector = static_cast<DeltaCollector*>(payload);
+    if(collector->appendHunk(d, h) == false) {
         Log::logText(LVL_DEBUG, QString("FAILED TO FIND MATCHING DELTA!!!!"));
     }
     return 0;
@@ -340,19 +611,98 @@ int Diff::hunkCallback(const git_diff_delta* d, const git_diff_hunk* h, void* pa
 
 int Diff::lineCallback(const git_diff_delta* d, const git_diff_hunk* h, const git_diff_line* l, void* payload)
 {
-    DiffDelta::List* collection = static_cast<DiffDelta::List*>(payload);
-    DiffDelta* delta = collection->getDiffDeltaPtr(DiffDelta(d));
-    if(delta != nullptr) {
-        DiffHunk* hunk = delta->hunksRef().getDiffHunkPtr(DiffHunk(h));
-        if(hunk != nullptr) {
-            hunk->appendLine(DiffLine(l));
-        }
-        else {
-            Log::logText(LVL_DEBUG, QString("FAILED TO FIND MATCHING HUNK!!!!"));
-        }
+    DeltaCollector* collector = static_cast<DeltaCollector*>(payload);
+    DiffHunk* hunk = collector->hunkFor(d, h);
+    if(hunk != nullptr) {
+        hunk->appendLine(DiffLine(l));
     }
     else {
-        Log::logText(LVL_DEBUG, QString("FAILED TO FIND MATCHING DELTA!!!!"));
+        Log::logText(LVL_DEBUG, QString("FAILED TO FIND MATCHING HUNK!!!!"));
     }
     return 0;
 }
+
+int Diff::visitFileCallback(const git_diff_delta* delta, float progress, void* payload)
+{
+    Q_UNUSED(progress)
+    return static_cast<DiffVisitor*>(payload)->onFile(DiffDelta(delta)) ? 0 : GIT_EUSER;
+}
+
+int Diff::visitBinaryCallback(const git_diff_delta* delta, const git_diff_binary* binary, void* payload)
+{
+    Q_UNUSED(delta)
+    return static_cast<DiffVisitor*>(payload)->onBinary(DiffBinary(binary)) ? 0 : GIT_EUSER;
+}
+
+int Diff::visitHunkCallback(const git_diff_delta* delta, const git_diff_hunk* hunk, void* payload)
+{
+    Q_UNUSED(delta)
+    return static_cast<DiffVisitor*>(payload)->onHunk(DiffHunk(hunk)) ? 0 : GIT_EUSER;
+}
+
+int Diff::visitLineCallback(const git_diff_delta* delta, const git_diff_hunk* hunk, const git_diff_line* line, void* payload)
+{
+    Q_UNUSED(delta)
+    Q_UNUSED(hunk)
+    return static_cast<DiffVisitor*>(payload)->onLine(DiffLineView(line)) ? 0 : GIT_EUSER;
+}
+
+// -------------------------------- Diff::DeltaCollector --------------------------------
+
+void Diff::DeltaCollector::appendDelta(const git_diff_delta* delta)
+{
+    _deltas.append(DiffDelta(delta));
+    _delta = delta;
+    _hunk = nullptr;
+}
+
+bool Diff::DeltaCollector::appendHunk(const git_diff_delta* delta, const git_diff_hunk* hunk)
+{
+    DiffDelta* target = deltaFor(delta);
+    if(target == nullptr) {
+        return false;
+    }
+    target->appendHunk(DiffHunk(hunk));
+    _hunk = target == &_deltas.last() ? hunk : nullptr;
+    return true;
+}
+
+DiffDelta* Diff::DeltaCollector::deltaFor(const git_diff_delta* delta)
+{
+    if(delta == _delta && _deltas.count() > 0) {
+        return &_deltas.last();
+    }
+    // not in the order libgit2 normally reports; search
+    return _deltas.getDiffDeltaPtr(DiffDelta(delta));
+}
+
+DiffHunk* Diff::DeltaCollector::hunkFor(const git_diff_delta* delta, const git_diff_hunk* hunk)
+{
+    DiffDelta* target = deltaFor(delta);
+    if(target == nullptr) {
+        return nullptr;
+    }
+    if(hunk == _hunk && target == &_deltas.last() && target->hunksRef().count() > 0) {
+        return &target->hunksRef().last();
+    }
+    return target->hunksRef().getDiffHunkPtr(DiffHunk(hunk));
+}
+
+// -------------------------------- Diff::BlobPair --------------------------------
+
+Diff::BlobPair::BlobPair(const git_diff_delta* delta) :
+    _oldId(&delta->old_file.id),
+    _newId(&delta->new_file.id),
+    _oldPath(delta->old_file.path),
+    _newPath(delta->new_file.path),
+    _oldMode(delta->old_file.mode),
+    _newMode(delta->new_file.mode),
+    _changed(delta->status != GIT_DELTA_UNMODIFIED && delta->status != GIT_DELTA_IGNORED && delta->status != GIT_DELTA_UNREADABLE)
+{
+}
+
+// Submodules are commits, not blobs, and have no patch
+bool Diff::BlobPair::hasPatch() const
+{
+    return _changed && _oldMode != GIT_FILEMODE_COMMIT && _newMode != GIT_FILEMODE_COMMIT && _oldId != _newId;
+}
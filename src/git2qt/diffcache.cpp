@@ -0,0 +1,193 @@
+#include "diffcache.h"
+
+#include <compareoptions.h>
+#include <diffoptions.h>
+#include <repository.h>
+
+#include <QDataStream>
+
+using namespace GIT;
+
+DiffCache::DiffCache(Repository* repo) :
+    GitEntity(DiffCacheEntity, repo)
+{
+    _cache.setMaxCost(DefaultMaxMemory);
+}
+
+bool DiffCache::findDeltas(const QByteArray& key, DiffDelta::List& deltas)
+{
+    QMutexLocker lock(&_mutex);
+    const Entry* found = _cache.object(key);
+    if(found == nullptr) {
+        _misses++;
+        return false;
+    }
+    _hits++;
+    deltas = found->deltas();
+    return true;
+}
+
+void DiffCache::insertDeltas(const QByteArray& key, const DiffDelta::List& deltas)
+{
+    Entry* entry = new Entry(deltas);
+    QMutexLocker lock(&_mutex);
+    _cache.insert(key, entry, entry->cost());
+}
+
+bool DiffCache::findChanges(const QByteArray& key, TreeChanges& changes)
+{
+    QMutexLocker lock(&_mutex);
+    const Entry* found = _cache.object(key);
+    if(found == nullptr) {
+        _misses++;
+        return false;
+    }
+    _hits++;
+    changes = found->changes();
+    return true;
+}
+
+void DiffCache::insertChanges(const QByteArray& key, const TreeChanges& changes)
+{
+    Entry* entry = new Entry(changes);
+    QMutexLocker lock(&_mutex);
+    _cache.insert(key, entry, entry->cost());
+}
+
+qsizetype DiffCache::maxMemory() const
+{
+    QMutexLocker lock(&_mutex);
+    return _cache.maxCost();
+}
+
+void DiffCache::setMaxMemory(qsizetype bytes)
+{
+    QMutexLocker lock(&_mutex);
+    _cache.setMaxCost(bytes);
+}
+
+qsizetype DiffCache::memoryUsed() const
+{
+    QMutexLocker lock(&_mutex);
+    return _cache.totalCost();
+}
+
+int DiffCache::count() const
+{
+    QMutexLocker lock(&_mutex);
+    return _cache.count();
+}
+
+quint64 DiffCache::hits() const
+{
+    QMutexLocker lock(&_mutex);
+    return _hits;
+}
+
+quint64 DiffCache::misses() const
+{
+    QMutexLocker lock(&_mutex);
+    return _misses;
+}
+
+double DiffCache::hitRate() const
+{
+    QMutexLocker lock(&_mutex);
+    quint64 total = _hits + _misses;
+    return total > 0 ? (double)_hits / (double)total : 0;
+}
+
+void DiffCache::resetStatistics()
+{
+    QMutexLocker lock(&_mutex);
+    _hits = 0;
+    _misses = 0;
+}
+
+void DiffCache::clear()
+{
+    QMutexLocker lock(&_mutex);
+    _cache.clear();
+}
+
+/**
+ * Everything which can change the deltas or their patches: the diff flags,
+ * context, pathspec and the rename detection which Diff::detectRenames()
+ * will run. With RenameDetectionDefault that depends on the repository's
+ * configuration, which the caller passes as configuredRenames.
+ */
+QByteArray DiffCache::deltasKey(const ObjectId& oldTreeId, const ObjectId& newTreeId, const DiffOptions& options, const CompareOptions& compareOptions,
+                                const QByteArray& configuredRenames)
+{
+    QByteArray result = makeKey('D', oldTreeId, newTreeId, options, options.flags());
+
+    QDataStream output(&result, QIODevice::Append);
+    output << options.contextLines() << options.interhunkLines();
+
+    SimilarityOptions similarity = compareOptions.similarity();
+    output << (int)similarity.renameDetectionMode();
+    if(similarity.renameDetectionMode() == SimilarityOptions::RenameDetectionDefault) {
+        output << configuredRenames;
+    }
+    else if(similarity.renameDetectionMode() != SimilarityOptions::RenameDetectionNone) {
+        git_diff_find_options find = similarity.toNativeDiffFindOptions();
+        output << find.flags << find.rename_threshold << find.rename_from_rewrite_threshold
+               << find.copy_threshold << find.break_rewrite_threshold << (quint64)find.rename_limit
+               << compareOptions.includeUnmodified();
+    }
+    return result;
+}
+
+/**
+ * A TreeChanges has no content and no rename detection, so flags which only
+ * shape the patch text are left out.
+ */
+QByteArray DiffCache::changesKey(const ObjectId& oldTreeId, const ObjectId& newTreeId, const DiffOptions& options)
+{
+    DiffOptionFlags flags = options.flags();
+    flags &= ~DiffOptionFlags(DiffOptionPatience | DiffOptionMinimal | DiffOptionIndentHeuristic);
+    return makeKey('C', oldTreeId, newTreeId, options, flags);
+}
+
+QByteArray DiffCache::makeKey(char kind, const ObjectId& oldTreeId, const ObjectId& newTreeId, const DiffOptions& options, DiffOptionFlags flags)
+{
+    // a pathspec selects the same files in any order
+    QStringList paths = options.paths();
+    paths.sort();
+
+    QByteArray result;
+    QDataStream output(&result, QIODevice::WriteOnly);
+    output << (qint8)kind;
+    output.writeRawData((const char*)oldTreeId.rawData(), GitOid::Size);
+    output.writeRawData((const char*)newTreeId.rawData(), GitOid::Size);
+    output << flags.toInt() << (int)options.ignoreSubmodules() << options.maxSize() << paths;
+    return result;
+}
+
+qsizetype DiffCache::Entry::cost() const
+{
+    qsizetype result = sizeof(Entry);
+    for(const DiffDelta& delta : _deltas) {
+        result += deltaCost(delta);
+    }
+    for(const TreeChangeEntry& change : _changes) {
+        result += sizeof(TreeChangeEntry) +
+                  (change.path().size() + change.oldPath().size()) * sizeof(QChar) +
+                  deltaCost(change.delta());
+    }
+    return result;
+}
+
+qsizetype DiffCache::Entry::deltaCost(const DiffDelta& delta)
+{
+    qsizetype result = sizeof(DiffDelta) +
+                       (delta.oldFile().path().size() + delta.newFile().path().size()) * sizeof(QChar) +
+                       delta.binaries().count() * sizeof(DiffBinary);
+    for(const DiffHunk& hunk : delta.hunks()) {
+        result += sizeof(DiffHunk) + hunk.header().size() * sizeof(QChar);
+        for(const DiffLine& line : hunk.lines()) {
+            result += sizeof(DiffLine) + line.content().size();
+        }
+    }
+    return result;
+}
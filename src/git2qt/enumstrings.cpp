@@ -16,6 +16,7 @@ const EnumStrings::TreeEntryTargetTypeToStringMap EnumStrings::_TreeEntryTargetT
 const EnumStrings::BranchTypeToStringMap EnumStrings::_BranchTypeToStringMap;
 const EnumStrings::ChangeKindToStringMap EnumStrings::_ChangeKindToStringMap;
 const EnumStrings::GitEntityTypeToStringMap EnumStrings::_GitEntityTypeToStringMap;
+const EnumStrings::GraphBuildStageToStringMap EnumStrings::_GraphBuildStageToStringMap;
 
 QString EnumStrings::getFileStatusString(FileStatuses value)
 {
@@ -184,4 +184,19 @@ QList<GitEntityType> getGitEntityTypeValues()
     return EnumStrings::getGitEntityTypeValues();
 }
 
+QString getGraphBuildStageString(GraphBuildStage value)
+{
+    return EnumStrings::getGraphBuildStageString(value);
+}
+
+GraphBuildStage getGraphBuildStage(const QString& value)
+{
+    return EnumStrings::getGraphBuildStage(value);
+}
+
+QList<GraphBuildStage> getGraphBuildStageValues()
+{
+    return EnumStrings::getGraphBuildStageValues();
+}
+
 }   // namespace
@@ -0,0 +1,103 @@
+#include "graphbuildstatistics.h"
+
+#include <QFile>
+#include <QTextStream>
+
+using namespace GIT;
+
+namespace {
+
+// Value of a "<name>: <n> kB" line of /proc/self/status, in bytes
+qint64 procStatusBytes(const QByteArray& name)
+{
+    qint64 result = 0;
+#ifdef Q_OS_LINUX
+    QFile file("/proc/self/status");
+    if(file.open(QIODevice::ReadOnly)) {
+        for(const QByteArray& line : file.readAll().split('\n')) {
+            if(line.startsWith(name + ':')) {
+                result = line.mid(name.length() + 1).trimmed().split(' ').first().toLongLong() * 1024;
+                break;
+            }
+        }
+    }
+#else
+    Q_UNUSED(name)
+#endif
+    return result;
+}
+
+// Reset the kernel's high-water mark of this process to its current resident size
+bool resetPeakResident()
+{
+    bool result = false;
+#ifdef Q_OS_LINUX
+    QFile file("/proc/self/clear_refs");
+    result = file.open(QIODevice::WriteOnly) && file.write("5") == 1;
+#endif
+    return result;
+}
+
+} // namespace
+
+qint64 GraphBuildStatistics::totalNanoseconds() const
+{
+    qint64 result = 0;
+    for(qint64 nanoseconds : _stageNanoseconds) {
+        result += nanoseconds;
+    }
+    return result;
+}
+
+QString GraphBuildStatistics::toString() const
+{
+    QString result;
+    QTextStream output(&result);
+    output << _commitCount << " commits in " << QString::number(totalNanoseconds() / 1000000.0, 'f', 2) << " ms, peak "
+           << (_peakResidentBytes / (1024 * 1024)) << " MB" << Qt::endl;
+    for(auto it = _stageNanoseconds.constBegin();it != _stageNanoseconds.constEnd();it++) {
+        output << "  " << getGraphBuildStageString(it.key()).leftJustified(16)
+               << QString::number(it.value() / 1000000.0, 'f', 2).rightJustified(10) << " ms "
+               << QString::number(_stageResidentBytes.value(it.key()) / (1024 * 1024)).rightJustified(8) << " MB" << Qt::endl;
+    }
+    return result;
+}
+
+/**
+ * VmHWM is the peak of the whole process since it started (or since it was
+ * last reset), so it is reset when a calculation begins. Where that is not
+ * allowed the peak is only the largest resident size seen as a stage finished.
+ */
+void GraphBuildStatistics::begin()
+{
+    _peakResettable = resetPeakResident();
+    _peakResidentBytes = procStatusBytes("VmRSS");
+}
+
+void GraphBuildStatistics::addStage(GraphBuildStage stage, qint64 nanoseconds)
+{
+    // a stage which runs more than once accumulates
+    qint64 residentBytes = procStatusBytes("VmRSS");
+    _stageNanoseconds[stage] += nanoseconds;
+    _stageResidentBytes[stage] = residentBytes;
+    _peakResidentBytes = qMax(_peakResidentBytes, residentBytes);
+    if(_peakResettable) {
+        _peakResidentBytes = qMax(_peakResidentBytes, procStatusBytes("VmHWM"));
+    }
+}
+
+/**
+ * Add the stage times of an earlier, abandoned calculation (e.g. an
+ * incremental one which fell back to a full calculation). The commit count
+ * and memory figures are those of this calculation where it has them.
+ */
+void GraphBuildStatistics::merge(const GraphBuildStatistics& earlier)
+{
+    for(auto it = earlier._stageNanoseconds.constBegin();it != earlier._stageNanoseconds.constEnd();it++) {
+        _stageNanoseconds[it.key()] += it.value();
+        if(_stageResidentBytes.contains(it.key()) == false) {
+            _stageResidentBytes.insert(it.key(), earlier._stageResidentBytes.value(it.key()));
+        }
+    }
+    _peakResidentBytes = qMax(_peakResidentBytes, earlier._peakResidentBytes);
+}
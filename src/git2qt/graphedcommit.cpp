@@ -12,22 +12,9 @@ GraphedCommit::GraphedCommit() :
 }
 
 GraphedCommit::GraphedCommit(const Commit& other) :
-    Commit(GraphedCommitEntity, other.repository(), other.objectId())
+    Commit(GraphedCommitEntity, other),
+    _parentObjectIds(other.parentIds())
 {
-    CommitHandle handle = createHandle();
-    try
-    {
-        throwIfTrue(handle.isNull());
-        int count = git_commit_parentcount(handle.value());
-        for(int i = 0;i < count;i++) {
-            const git_oid* oid = git_commit_parent_id(handle.value(), i);
-            throwIfNull(oid);
-            _parentObjectIds.append(oid);
-        }
-    }
-    catch(const GitException&)
-    {
-    }
 }
 
 bool GraphedCommit::operator ==(const GraphedCommit& other) const
@@ -114,7 +101,7 @@ GraphedCommit::List GraphedCommit::List::findChildren(const GraphedCommit& of) c
         if(of.isStashBase() && commit.isStash() && of.stashBaseOf() == commit.objectId()) {
             result.append(commit);
         }
-        else if(commit.parents().objectIds().contains(of.objectId())) {
+        else if(commit.parentIds().contains(of.objectId())) {
             result.append(commit);
         }
     }
@@ -0,0 +1,211 @@
+#include "graphlayout.h"
+
+using namespace GIT;
+
+GraphLine GraphLayout::graphLine(int row) const
+{
+    GraphLine::List lines = graphLines(row, 1);
+    return lines.count() > 0 ? lines.at(0) : GraphLine();
+}
+
+GraphLine::List GraphLayout::graphLines(int firstRow, int count) const
+{
+    firstRow = qMax(firstRow, 0);
+    count = qMin(count, rowCount() - firstRow);
+    if(count <= 0) {
+        return GraphLine::List();
+    }
+
+    Window window(firstRow, count);
+
+    // rows above the window whose lines reach into it
+    int bucket = firstRow / BucketSize;
+    for(int row : _crossingRows.at(bucket)) {
+        if(_reach.at(row) >= firstRow) {
+            drawRow(row, window);
+        }
+    }
+
+    // rows from the start of the bucket down to the end of the window
+    for(int row = bucket * BucketSize;row < window.endRow();row++) {
+        if(_reach.at(row) >= firstRow) {
+            drawRow(row, window);
+        }
+    }
+    return window.lines();
+}
+
+void GraphLayout::addRow(int level, bool merge, int mergeFromRow, int mergeBaseRow, const QList<int>& parentRows)
+{
+    int row = _levels.count();
+    _levels.append(level);
+    _merges.append(merge);
+    _mergeFromRows.append(mergeFromRow);
+    _mergeBaseRows.append(mergeBaseRow);
+    _parentRows.append(parentRows);
+    _parentOffsets.append(_parentRows.count());
+
+    // the last row this row draws on
+    int reach = row;
+    if(merge) {
+        reach = qMax(reach, qMax(mergeFromRow, mergeBaseRow));
+    }
+    else {
+        for(int parentRow : parentRows) {
+            reach = qMax(reach, parentRow);
+        }
+    }
+    _reach.append(reach);
+}
+
+void GraphLayout::buildIndex()
+{
+    _crossingRows.clear();
+    _crossingRows.resize((rowCount() / BucketSize) + 1);
+    for(int row = 0;row < rowCount();row++) {
+        int lastBucket = _reach.at(row) / BucketSize;
+        for(int bucket = (row / BucketSize) + 1;bucket <= lastBucket;bucket++) {
+            _crossingRows[bucket].append(row);
+        }
+    }
+}
+
+void GraphLayout::drawRow(int row, Window& window) const
+{
+    int level = _levels.at(row);
+
+    // Always a dot at level
+    window.set(row, level, (_merges.at(row) ? MergeDot : CommitDot) | VerticalDown);
+
+    // If a merge, we will also go down and left-or-right
+    if(_merges.at(row)) {
+        // either may be missing when only part of the history is laid out
+        int mergeFromRow = _mergeFromRows.at(row);
+        if(mergeFromRow != NoRow) {
+            drawMergeLine(row, mergeFromRow, _levels.at(mergeFromRow), window);
+        }
+
+        int mergeBaseRow = _mergeBaseRows.at(row);
+        if(mergeBaseRow != NoRow) {
+            drawMergeLine(row, mergeBaseRow, level, window);
+        }
+        return;
+    }
+
+    for(int i = _parentOffsets.at(row);i < _parentOffsets.at(row + 1);i++) {
+        int parentRow = _parentRows.at(i);
+        int parentLevel = _levels.at(parentRow);
+
+        // draw verticals from this down to parent - 1
+        drawVertical(row + 1, parentRow, level, window);
+
+        // draw curves and horizontals at the parent
+        if(parentLevel == level) {
+            window.set(parentRow, level, VerticalUp);
+        }
+        else if(parentLevel < level) {
+            window.set(parentRow, level, DownToLeft);
+            if(parentLevel < level - 1) {
+                window.set(parentRow, parentLevel, HorizontalRight);
+            }
+
+            for(int lineLevel = parentLevel + 1;lineLevel < level;lineLevel++) {
+                window.set(parentRow, lineLevel, HorizontalLeft);
+                if(lineLevel < level - 1) {
+                    window.set(parentRow, lineLevel, HorizontalRight);
+                }
+            }
+        }
+        else {
+            window.set(parentRow, level, DownToRight);
+            if(level < parentLevel - 1) {
+                window.set(parentRow, parentLevel, HorizontalLeft);
+            }
+            for(int lineLevel = level + 1;lineLevel < parentLevel;lineLevel++) {
+                window.set(parentRow, lineLevel, HorizontalRight);
+                if(lineLevel > level + 1) {
+                    window.set(parentRow, lineLevel, HorizontalLeft);
+                }
+            }
+        }
+    }
+}
+
+void GraphLayout::drawMergeLine(int row, int toRow, int lineLevel, Window& window) const
+{
+    int level = _levels.at(row);
+    int toLevel = _levels.at(toRow);
+
+    // draw first row horizontal stuff
+    if(lineLevel > level) {
+        drawHorizontal(row, level, lineLevel - 1, window);
+        window.set(row, lineLevel - 1, RightThenDown);
+    }
+    else if(lineLevel < level) {
+        drawHorizontal(row, level, lineLevel + 1, window);
+        window.set(row, lineLevel + 1, LeftThenDown);
+    }
+    else {
+        window.set(row, level, VerticalDown);
+    }
+
+    // draw verticals
+    drawVertical(row + 1, toRow, lineLevel, window);
+
+    if(lineLevel != toLevel) {
+        // draw last row horizontal stuff
+        if(toLevel > level) {
+            drawHorizontal(toRow, level + 1, toLevel, window);
+            window.set(toRow, lineLevel, DownToRight);
+        }
+        else if(toLevel < level) {
+            drawHorizontal(toRow, level - 1, toLevel, window);
+            window.set(toRow, lineLevel, DownToLeft);
+        }
+        else {
+            window.set(toRow, level, VerticalUp);
+        }
+    }
+    else {
+        window.set(toRow, toLevel, VerticalUp);
+    }
+}
+
+void GraphLayout::drawVertical(int fromRow, int toRow, int level, Window& window) const
+{
+    // only the part of the line inside the window
+    int from = qMax(fromRow, window.firstRow());
+    int to = qMin(toRow, window.endRow());
+    for(int row = from;row < to;row++) {
+        window.set(row, level, VerticalUp | VerticalDown);
+    }
+}
+
+void GraphLayout::drawHorizontal(int row, int fromLevel, int toLevel, Window& window)
+{
+    int from = qMin(fromLevel, toLevel);
+    int to = qMax(fromLevel, toLevel);
+
+    if(to == from) {
+        return;
+    }
+
+    // draw end half-lines
+    window.set(row, from, HorizontalRight);
+    window.set(row, to, HorizontalLeft);
+
+    // draw horizontal as needed
+    for(int level = from + 1;level < to;level++) {
+        window.set(row, level, HorizontalRight | HorizontalLeft);
+    }
+}
+
+GraphLine::List GraphLayout::Window::lines() const
+{
+    GraphLine::List result;
+    result.reserve(_lines.count());
+    for(const GraphLine& line : _lines) {
+        result.append(line);
+    }
+    return result;
+}
@@ -2,6 +2,40 @@
 
 using namespace GIT;
 
+void GraphLine::setGraphItem(int level, GraphItemTypes types)
+{
+    if(level < 0 || types == NoGraphItem) {
+        return;
+    }
+
+    if(level >= InlineLevels && level - InlineLevels >= _overflow.count()) {
+        _overflow.resize(level - InlineLevels + 1);
+    }
+    if(level >= _levelCount) {
+        _levelCount = level + 1;
+    }
+
+    quint16 bits = (quint16)types.toInt();
+    if(level < InlineLevels) {
+        _inline[level] |= bits;
+    }
+    else {
+        _overflow[level - InlineLevels] |= bits;
+    }
+}
+
+QMap<int, GraphItemTypes> GraphLine::graphItems() const
+{
+    QMap<int, GraphItemTypes> result;
+    for(int level = 0;level < _levelCount;level++) {
+        quint16 bits = rawItem(level);
+        if(bits != 0) {
+            result.insert(level, GraphItemTypes::fromInt(bits));
+        }
+    }
+    return result;
+}
+
 void GraphLine::makeHorizontals(int fromLevel, int toLevel)
 {
     if(fromLevel < toLevel) {
@@ -33,5 +67,5 @@ void GraphLine::makeHorizontals(int fromLevel, int toLevel)
 
 bool GraphLine::hasHorizontal(int atLevel) const
 {
-    return _graphItems.contains(atLevel) && (_graphItems.value(atLevel) & AnyHorizontal) != 0;
+    return (graphItem(atLevel) & AnyHorizontal) != 0;
 }
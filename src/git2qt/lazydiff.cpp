@@ -0,0 +1,121 @@
+#include "lazydiff.h"
+
+using namespace GIT;
+
+LazyDiff::LazyDiff(git_diff* diff) :
+    _diff(diff, git_diff_free) {}
+
+int LazyDiff::count() const
+{
+    return _diff.isNull() ? 0 : (int)git_diff_num_deltas(_diff.data());
+}
+
+DiffDelta LazyDiff::delta(int index) const
+{
+    DiffDelta result;
+    if(index >= 0 && index < count()) {
+        result = DiffDelta(git_diff_get_delta(_diff.data(), index));
+    }
+    return result;
+}
+
+DiffDelta::List LazyDiff::deltas(bool withLineStats) const
+{
+    DiffDelta::List result;
+    int deltaCount = count();
+    result.reserve(deltaCount);
+    for(int index = 0;index < deltaCount;index++) {
+        DiffDelta delta(git_diff_get_delta(_diff.data(), index));
+        if(withLineStats) {
+            loadLineStats(index, delta);
+        }
+        result.append(std::move(delta));
+    }
+    return result;
+}
+
+/**
+ * Binary files have no hunks, so their delta comes back as it is.
+ */
+DiffDelta LazyDiff::patch(int index) const
+{
+    DiffDelta result;
+    if(index < 0 || index >= count()) {
+        return result;
+    }
+
+    git_patch* patch = nullptr;
+    if(git_patch_from_diff(&patch, _diff.data(), index) != 0 || patch == nullptr) {
+        return DiffDelta(git_diff_get_delta(_diff.data(), index));
+    }
+
+    // the patch's delta knows whether the content turned out to be binary
+    result = DiffDelta(git_patch_get_delta(patch));
+    loadLineStats(patch, result);
+    loadHunks(patch, result);
+
+    git_patch_free(patch);
+    return result;
+}
+
+DiffDelta LazyDiff::patch(const QString& path) const
+{
+    return patch(indexOf(path));
+}
+
+int LazyDiff::indexOf(const QString& path) const
+{
+    int deltaCount = count();
+    QByteArray utf8 = path.toUtf8();
+    for(int index = 0;index < deltaCount;index++) {
+        const git_diff_delta* delta = git_diff_get_delta(_diff.data(), index);
+        if(utf8 == delta->new_file.path || utf8 == delta->old_file.path) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+bool LazyDiff::loadLineStats(int index, DiffDelta& delta) const
+{
+    bool result = false;
+    git_patch* patch = nullptr;
+    if(git_patch_from_diff(&patch, _diff.data(), index) == 0 && patch != nullptr) {
+        result = loadLineStats(patch, delta);
+        git_patch_free(patch);
+    }
+    return result;
+}
+
+void LazyDiff::loadHunks(git_patch* patch, DiffDelta& delta)
+{
+    int hunkCount = git_patch_num_hunks(patch);
+    for(int hunkIndex = 0;hunkIndex < hunkCount;hunkIndex++) {
+        const git_diff_hunk* h = nullptr;
+        size_t lineCount = 0;
+        if(git_patch_get_hunk(&h, &lineCount, patch, hunkIndex) != 0) {
+            break;
+        }
+
+        DiffHunk hunk(h);
+        for(int lineIndex = 0;lineIndex < (int)lineCount;lineIndex++) {
+            const git_diff_line* line = nullptr;
+            if(git_patch_get_line_in_hunk(&line, patch, hunkIndex, lineIndex) == 0) {
+                hunk.appendLine(DiffLine(line));
+            }
+        }
+        delta.appendHunk(std::move(hunk));
+    }
+}
+
+// Like `git diff --numstat`, binary files have no line counts
+bool LazyDiff::loadLineStats(git_patch* patch, DiffDelta& delta)
+{
+    size_t additions = 0, deletions = 0;
+    if((git_patch_get_delta(patch)->flags & GIT_DIFF_FLAG_BINARY) != 0 ||
+       git_patch_line_stats(nullptr, &additions, &deletions, patch) != 0) {
+        return false;
+    }
+    delta.setLineStats(additions, deletions);
+    return true;
+}
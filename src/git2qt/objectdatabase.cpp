@@ -3,6 +3,11 @@
 #include <gitexception.h>
 #include <repository.h>
 #include <tree.h>
+#include <utility.h>
+#include <git2/sys/commit_graph.h>
+#include <git2qt/private/commitgraphfile.h>
+
+#include <QDir>
 
 using namespace GIT;
 
@@ -138,6 +143,90 @@ QByteArray ObjectDatabase::readBlobData(const Blob& blob)
     return result;
 }
 
+/**
+ * Write objects/info/commit-graph covering every commit reachable from
+ * the references and HEAD. libgit2 only writes single-file graphs, so
+ * this always rewrites the whole file.
+ */
+bool ObjectDatabase::writeCommitGraph()
+{
+    bool result = false;
+    git_commit_graph_writer* writer = nullptr;
+    git_revwalk* walker = nullptr;
+
+    try
+    {
+        QString infoDir = Utility::combine(git_repository_commondir(repository()->handle().value()), "objects/info");
+        throwIfFalse(QDir().mkpath(infoDir), "Failed to create objects/info");
+
+        throwOnError(git_commit_graph_writer_new(&writer, infoDir.toUtf8().constData()));
+        throwOnError(git_revwalk_new(&walker, repository()->handle().value()));
+        throwOnError(git_revwalk_push_glob(walker, "refs/*"));
+
+        // HEAD may be unborn or detached. Neither is an error here.
+        git_revwalk_push_head(walker);
+
+        throwOnError(git_commit_graph_writer_add_revwalk(writer, walker));
+
+        git_commit_graph_writer_options options = GIT_COMMIT_GRAPH_WRITER_OPTIONS_INIT;
+        throwOnError(git_commit_graph_writer_commit(writer, &options));
+        result = true;
+    }
+    catch(const GitException&)
+    {
+    }
+
+    if(walker != nullptr) {
+        git_revwalk_free(walker);
+    }
+    if(writer != nullptr) {
+        git_commit_graph_writer_free(writer);
+    }
+    return result;
+}
+
+/**
+ * The commit-graph is stale when it is missing or when any reference
+ * (or a detached HEAD) peels to a commit which is not in the file.
+ */
+bool ObjectDatabase::isCommitGraphStale() const
+{
+    const CommitGraphFile* graphFile = repository()->commitGraphFile();
+    if(graphFile == nullptr || graphFile->isValid() == false) {
+        return true;
+    }
+
+    bool stale = false;
+    git_reference_iterator* it = nullptr;
+    try
+    {
+        throwOnError(git_reference_iterator_new(&it, repository()->handle().value()));
+        git_reference* ref = nullptr;
+        while(stale == false && git_reference_next(&ref, it) == 0) {
+            git_object* obj = nullptr;
+            if(git_reference_peel(&obj, ref, GIT_OBJECT_COMMIT) == 0) {
+                stale = graphFile->positionOf(ObjectId(obj)) < 0;
+                git_object_free(obj);
+            }
+            git_reference_free(ref);
+        }
+
+        git_oid headOid;
+        if(stale == false && git_reference_name_to_id(&headOid, repository()->handle().value(), "HEAD") == 0) {
+            stale = graphFile->positionOf(ObjectId(headOid)) < 0;
+        }
+    }
+    catch(const GitException&)
+    {
+        stale = true;
+    }
+
+    if(it != nullptr) {
+        git_reference_iterator_free(it);
+    }
+    return stale;
+}
+
 ObjectDatabaseHandle ObjectDatabase::createHandle() const
 {
     ObjectDatabaseHandle handle;
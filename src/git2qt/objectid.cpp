@@ -4,45 +4,40 @@
 
 using namespace GIT;
 
+const git_oid ObjectId::Empty = { { 0 } };
+
 ObjectId::ObjectId(const GitOid& oid) :
-    _oid(oid)
+    _oid(*oid.toNative())
 {
-    _sha = oid.id().toHex().toLower();
-    calculateParts();
 }
 
 ObjectId::ObjectId(const git_oid& oid) :
     _oid(oid)
 {
-    _sha = _oid.id().toHex().toLower();
-    calculateParts();
 }
 
-ObjectId::ObjectId(const git_oid* oid) :
-    _oid(oid)
+ObjectId::ObjectId(const git_oid* oid)
 {
-    _sha = _oid.id().toHex().toLower();
-    calculateParts();
+    if(oid != nullptr) {
+        _oid = *oid;
+    }
 }
 
 ObjectId::ObjectId(const git_object* obj)
 {
     const git_oid* oid = git_object_id(obj);
     if(oid != nullptr) {
-        _oid = GitOid(oid);
-        _sha = _oid.id().toHex().toLower();
-        calculateParts();
+        _oid = *oid;
     }
 }
 
-ObjectId::ObjectId(const QString& sha) :
-    _oid(sha), _sha(sha)
+ObjectId::ObjectId(const QString& sha)
 {
-    QByteArray buf = QByteArray::fromHex(sha.toUtf8());
-    if(buf.length() != GitOid::Size) {
-        _oid = GitOid();
-        _sha = QString();
-        calculateParts();
+    if(sha.length() == HexSize) {
+        QByteArray buf = QByteArray::fromHex(sha.toLatin1());
+        if(buf.length() == _rawSize) {
+            memcpy(_oid.id, buf.constData(), _rawSize);
+        }
     }
 }
 
@@ -51,8 +46,7 @@ ObjectId ObjectId::createFromHandle(git_reference* handle)
     ObjectId result;
     const git_oid* oid = git_reference_target(handle);
     if(oid != nullptr) {
-        GitOid gitOid(oid->id, GIT_OID_MAX_SIZE);
-        result = ObjectId(gitOid);
+        result = ObjectId(oid);
     }
     return result;
 }
@@ -68,18 +62,22 @@ ObjectId ObjectId::createFromReference(const Reference& reference)
     return result;
 }
 
-bool ObjectId::isValid(const QString& sha)
+QString ObjectId::toString(int count) const
 {
-    QByteArray data = QByteArray::fromHex(sha.toUtf8());
-    return data.length() == _rawSize;
+    if(isNull()) {
+        return QString();
+    }
+
+    if(count <= 0 || count > HexSize) {
+        count = HexSize;
+    }
+    char buf[HexSize];
+    git_oid_nfmt(buf, count, &_oid);
+    return QString::fromLatin1(buf, count);
 }
 
-void ObjectId::calculateParts()
+bool ObjectId::isValid(const QString& sha)
 {
-    if(_sha.length() == HexSize) {
-        QStringView s(_sha);
-        _p1 = s.mid(0, 16).toULongLong(nullptr, 16);
-        _p2 = s.mid(16, 16).toULongLong(nullptr, 16);
-        _p3 = s.mid(32, 8).toULongLong(nullptr, 16);
-    }
+    QByteArray data = QByteArray::fromHex(sha.toUtf8());
+    return data.length() == _rawSize;
 }
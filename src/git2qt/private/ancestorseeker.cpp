@@ -1,6 +1,5 @@
 #include "ancestorseeker.h"
 
-#include <QElapsedTimer>
 #include <gitexception.h>
 #include <repository.h>
 #include <utility.h>
@@ -19,15 +18,9 @@ void MergeBaseSeeker::resolve1()
 
 void MergeBaseSeeker::resolve2()
 {
-#undef PERF_TEST
-#ifdef PERF_TEST
-    static TimeSpan longest;
-    QElapsedTimer timer;
-    timer.start();
-#endif
     // we will find a common ancestor to all parents
     SeekerSet seekers;
-    for(GraphBuilderCommit* parent : _mergeCommit->parentCommitsRef()) {
+    for(GraphBuilderCommit* parent : _mergeCommit->parentCommits()) {
         seekers.append(new AncestorSeeker(parent));
     }
 
@@ -56,22 +49,86 @@ void MergeBaseSeeker::resolve2()
         }
     }
 
-#ifdef PERF_TEST
-    TimeSpan elapsed = TimeSpan::fromNanoseconds(timer.nsecsElapsed());
-    if(elapsed > longest) {
-        longest = elapsed;
-        Log::logText(LVL_DEBUG, QString("Seeker for %1 took %2").arg(_mergeCommit->objectId().toString()).arg(longest.toString(true)));
-    }
-#endif
     qDeleteAll(seekers);
 }
 
+// ---------------------------------- MergeBirthSeeker ----------------------------------
+
+MergeBirthSeeker::MergeBirthSeeker(const GraphBuilderCommit::PtrList& commits, const GraphBuilderCommit::Map& commitIndex) :
+    _commits(commits), _commitIndex(commitIndex)
+{
+    _masks.resize(commits.count());
+}
+
+GraphBuilderCommit* MergeBirthSeeker::findBirthCommit(GraphBuilderCommit* mergeCommit)
+{
+    GraphBuilderCommit::EdgeList parents = mergeCommit->parentCommits();
+    if(parents.count() == 0) {
+        return nullptr;
+    }
+    if(parents.count() > 64) {
+        MergeBaseSeeker seeker(mergeCommit, _commitIndex);
+        return seeker.birthCommit();
+    }
+
+    quint64 fullMask = parents.count() == 64 ? ~0ULL : (1ULL << parents.count()) - 1;
+    GraphBuilderCommit* result = nullptr;
+
+    _frontier.clear();
+    for(int i = 0;i < parents.count() && result == nullptr;i++) {
+        int index = parents.at(i)->index();
+        if(reach(index, 1ULL << i, fullMask)) {
+            result = _commits.at(index);
+        }
+    }
+
+    while(result == nullptr && _frontier.count() > 0) {
+        _next.clear();
+        _frontier.swap(_next);
+        for(int i = 0;i < _next.count() && result == nullptr;i++) {
+            GraphBuilderCommit* commit = _commits.at(_next.at(i));
+            quint64 mask = _masks.at(_next.at(i));
+            for(GraphBuilderCommit* parent : commit->parentCommits()) {
+                if(reach(parent->index(), mask, fullMask)) {
+                    result = parent;
+                    break;
+                }
+            }
+        }
+    }
+
+    // only clear what was touched so the next merge starts clean
+    for(int index : _touched) {
+        _masks[index] = 0;
+    }
+    _touched.clear();
+
+    return result;
+}
+
+bool MergeBirthSeeker::reach(int index, quint64 mask, quint64 fullMask)
+{
+    quint64 previous = _masks.at(index);
+    quint64 combined = previous | mask;
+    if(combined == previous) {
+        return false;
+    }
+
+    if(previous == 0) {
+        _touched.append(index);
+    }
+    _masks[index] = combined;
+
+    // commits whose mask grew must be expanded (again) on the next step
+    _frontier.append(index);
+    return combined == fullMask;
+}
 
 AncestorSeeker::AncestorSeeker(GraphBuilderCommit *commit) :
     _commit(commit), _oldestAncestor(commit->timestamp())
 {
     _ancestors.insert(commit->objectId());
-    for(GraphBuilderCommit* parent : commit->parentCommitsRef()) {
+    for(GraphBuilderCommit* parent : commit->parentCommits()) {
         _tips.insert(parent);
     }
 }
@@ -93,7 +150,7 @@ void AncestorSeeker::produceAncestors(int count)
                 _oldestAncestor = tip->timestamp();
             }
             _tips.remove(tip);
-            for(GraphBuilderCommit* parent : tip->parentCommitsRef()) {
+            for(GraphBuilderCommit* parent : tip->parentCommits()) {
                 _tips.insert(parent);
             }
         }
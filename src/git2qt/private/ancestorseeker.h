@@ -20,6 +20,34 @@ private:
     GraphBuilderCommit* _birthCommit;
 };
 
+/**
+ * Finds the commit at which the parents of a merge meet (the merge birth).
+ *
+ * Does a lock-step breadth first search from all parents at once over
+ * commit row indexes. Each commit reached gets a bitmask of the parents it
+ * is reachable from, kept in a flat array which is reused between merges.
+ * The first commit whose mask covers every parent is the birth commit.
+ *
+ * Merges with more than 64 parents fall back to MergeBaseSeeker.
+ */
+class MergeBirthSeeker
+{
+public:
+    MergeBirthSeeker(const GraphBuilderCommit::PtrList& commits, const GraphBuilderCommit::Map& commitIndex);
+
+    GraphBuilderCommit* findBirthCommit(GraphBuilderCommit* mergeCommit);
+
+private:
+    bool reach(int index, quint64 mask, quint64 fullMask);
+
+    const GraphBuilderCommit::PtrList& _commits;
+    const GraphBuilderCommit::Map& _commitIndex;
+    QVector<quint64> _masks;
+    QVector<int> _touched;
+    QVector<int> _frontier;
+    QVector<int> _next;
+};
+
 class MergeTip
 {
 public:
@@ -0,0 +1,142 @@
+#include "commitdetails.h"
+
+#include <QStringList>
+
+using namespace GIT;
+
+CommitDetails::CommitDetails(const git_commit* commit) :
+    _resolved(true),
+    _summaryResolved(true)
+{
+    _author = Signature(git_commit_author(commit));
+    _committer = Signature(git_commit_committer(commit));
+    _message = git_commit_message(commit);
+    _shortMessage = git_commit_summary(const_cast<git_commit*>(commit));
+    _encoding = git_commit_message_encoding(commit);
+}
+
+CommitDetails::CommitDetails(git_odb* odb, const ObjectId& objectId) :
+    _odb(odb),
+    _objectId(objectId)
+{
+}
+
+CommitDetails::~CommitDetails()
+{
+    if(_odb != nullptr) {
+        git_odb_free(_odb);
+    }
+}
+
+Signature CommitDetails::author()
+{
+    QMutexLocker locker(&_mutex);
+    resolve();
+    return _author;
+}
+
+Signature CommitDetails::committer()
+{
+    QMutexLocker locker(&_mutex);
+    resolve();
+    return _committer;
+}
+
+QString CommitDetails::message()
+{
+    QMutexLocker locker(&_mutex);
+    resolve();
+    return _message;
+}
+
+QString CommitDetails::shortMessage()
+{
+    QMutexLocker locker(&_mutex);
+    if(_summaryResolved == false) {
+        resolve();
+    }
+    return _shortMessage;
+}
+
+QString CommitDetails::encoding()
+{
+    QMutexLocker locker(&_mutex);
+    resolve();
+    return _encoding;
+}
+
+// Called with the mutex held
+void CommitDetails::resolve()
+{
+    if(_resolved) {
+        return;
+    }
+    _resolved = true;
+
+    git_odb_object* object = nullptr;
+    if(_odb != nullptr && git_odb_read(&object, _odb, _objectId.toNative()) == 0) {
+        if(git_odb_object_type(object) == GIT_OBJECT_COMMIT) {
+            decode(QByteArray::fromRawData(static_cast<const char*>(git_odb_object_data(object)), git_odb_object_size(object)));
+        }
+        git_odb_object_free(object);
+    }
+
+    // nothing else will be read, so let go of the object database
+    if(_odb != nullptr) {
+        git_odb_free(_odb);
+        _odb = nullptr;
+    }
+
+    if(_summaryResolved == false) {
+        _shortMessage = summaryOf(_message);
+        _summaryResolved = true;
+    }
+}
+
+// The header lines run up to the first empty line. Continuation lines
+// of multi-line headers (gpgsig, mergetag) start with a space and are skipped.
+void CommitDetails::decode(const QByteArray& data)
+{
+    int position = 0;
+    while(position < data.length() && data.at(position) != '\n') {
+        int end = data.indexOf('\n', position);
+        if(end < 0) {
+            end = data.length();
+        }
+
+        QByteArray line = data.mid(position, end - position);
+        git_signature* signature = nullptr;
+        if(line.startsWith("author ") && git_signature_from_buffer(&signature, line.mid(7).constData()) == 0) {
+            _author = Signature(signature);
+        }
+        else if(line.startsWith("committer ") && git_signature_from_buffer(&signature, line.mid(10).constData()) == 0) {
+            _committer = Signature(signature);
+        }
+        else if(line.startsWith("encoding ")) {
+            _encoding = QString::fromUtf8(line.mid(9));
+        }
+        if(signature != nullptr) {
+            git_signature_free(signature);
+        }
+        position = end + 1;
+    }
+
+    // like git_commit_message(), drop the newlines in front of the message
+    while(position < data.length() && data.at(position) == '\n') {
+        position++;
+    }
+    _message = QString::fromUtf8(data.mid(position));
+}
+
+// The first paragraph of the message on a single line, as git_commit_summary() makes it
+QString CommitDetails::summaryOf(const QString& message)
+{
+    QStringList lines;
+    for(const QString& line : message.trimmed().split('\n')) {
+        if(line.trimmed().isEmpty()) {
+            break;
+        }
+        lines.append(line.trimmed());
+    }
+    return lines.join(' ');
+}
@@ -0,0 +1,66 @@
+#ifndef COMMITDETAILS_H
+#define COMMITDETAILS_H
+#include <git2qt/signature.h>
+#include <git2qt/objectid.h>
+
+#include <QMutex>
+
+namespace GIT {
+
+/**
+ * The message, signatures and encoding of a commit, shared by every copy of it.
+ *
+ * Built from a git_commit which is already at hand, everything is decoded at
+ * once. Otherwise the details hold a reference to the object database and
+ * read and decode the raw commit the first time one of them is asked for.
+ * That holds no Repository*, so the details stay usable after the repository
+ * is gone, and resolution is serialized so copies may be read from any thread.
+ *
+ * The setters are only for details which are not shared yet; Commit makes
+ * its own copy before changing anything.
+ */
+class CommitDetails
+{
+public:
+    CommitDetails() : _resolved(true), _summaryResolved(true) {}
+    CommitDetails(const git_commit* commit);
+    CommitDetails(git_odb* odb, const ObjectId& objectId);
+    virtual ~CommitDetails();
+
+    Signature author();
+    void setAuthor(const Signature& value) { _author = value; }
+
+    Signature committer();
+    void setCommitter(const Signature& value) { _committer = value; }
+
+    QString message();
+    void setMessage(const QString& value) { _message = value; }
+
+    QString shortMessage();
+    void setShortMessage(const QString& value) { _shortMessage = value; _summaryResolved = true; }
+
+    QString encoding();
+    void setEncoding(const QString& value) { _encoding = value; }
+
+private:
+    void resolve();
+    void decode(const QByteArray& data);
+
+    static QString summaryOf(const QString& message);
+
+    QMutex _mutex;
+    git_odb* _odb = nullptr;
+    ObjectId _objectId;
+
+    bool _resolved = false;
+    bool _summaryResolved = false;
+    Signature _author;
+    Signature _committer;
+    QString _message;
+    QString _shortMessage;
+    QString _encoding;
+};
+
+} // namespace GIT
+
+#endif // COMMITDETAILS_H
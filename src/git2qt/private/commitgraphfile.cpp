@@ -0,0 +1,283 @@
+#include "commitgraphfile.h"
+
+#include <QtEndian>
+#include <log.h>
+#include <repository.h>
+#include <utility.h>
+
+using namespace GIT;
+
+CommitGraphFile::CommitGraphFile()
+{
+}
+
+CommitGraphFile::~CommitGraphFile()
+{
+    unload();
+}
+
+bool CommitGraphFile::load(const QString& path)
+{
+    unload();
+
+    _file.setFileName(path);
+    if(_file.exists() == false || _file.open(QIODevice::ReadOnly) == false) {
+        return false;
+    }
+
+    _size = _file.size();
+    _data = _file.map(0, _size);
+    if(_data == nullptr || findChunks() == false) {
+        Log::logText(LVL_DEBUG, QString("Ignoring unusable commit-graph at %1").arg(path));
+        unload();
+        return false;
+    }
+    return true;
+}
+
+void CommitGraphFile::unload()
+{
+    if(_data != nullptr) {
+        _file.unmap(const_cast<uchar*>(_data));
+    }
+    if(_file.isOpen()) {
+        _file.close();
+    }
+    _data = nullptr;
+    _size = 0;
+    _fanout = nullptr;
+    _oidLookup = nullptr;
+    _commitData = nullptr;
+    _extraEdges = nullptr;
+    _count = 0;
+    _extraEdgeCount = 0;
+}
+
+bool CommitGraphFile::findChunks()
+{
+    if(_size < HeaderSize + ChunkEntrySize) {
+        return false;
+    }
+
+    // header: signature, version, hash version, chunk count, base graph count
+    if(qFromBigEndian<quint32>(_data) != FileSignature ||
+       _data[4] != 1 ||
+       _data[5] != 1 ||
+       _data[7] != 0) {
+        return false;
+    }
+
+    int chunkCount = _data[6];
+    if(HeaderSize + (chunkCount + 1) * ChunkEntrySize > _size) {
+        return false;
+    }
+
+    quint64 fanoutSize = 0, lookupSize = 0, commitDataSize = 0, edgeSize = 0;
+    for(int i = 0;i < chunkCount;i++) {
+        const uchar* entry = _data + HeaderSize + (i * ChunkEntrySize);
+        quint32 id = qFromBigEndian<quint32>(entry);
+        quint64 offset = qFromBigEndian<quint64>(entry + 4);
+        quint64 nextOffset = qFromBigEndian<quint64>(entry + 4 + ChunkEntrySize);
+        if(offset > nextOffset || nextOffset > (quint64)_size) {
+            return false;
+        }
+
+        quint64 length = nextOffset - offset;
+        switch(id) {
+        case ChunkFanout:
+            _fanout = _data + offset;
+            fanoutSize = length;
+            break;
+        case ChunkLookup:
+            _oidLookup = _data + offset;
+            lookupSize = length;
+            break;
+        case ChunkCommitData:
+            _commitData = _data + offset;
+            commitDataSize = length;
+            break;
+        case ChunkExtraEdges:
+            _extraEdges = _data + offset;
+            edgeSize = length;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if(_fanout == nullptr || _oidLookup == nullptr || _commitData == nullptr || fanoutSize != FanoutSize) {
+        return false;
+    }
+
+    // positionOf() trusts the fanout to bound its search within the lookup table
+    quint32 previous = 0;
+    for(int i = 0;i < 256;i++) {
+        quint32 value = qFromBigEndian<quint32>(_fanout + (i * 4));
+        if(value < previous) {
+            return false;
+        }
+        previous = value;
+    }
+    if(previous > PositionMask) {
+        return false;
+    }
+
+    _count = previous;
+    _extraEdgeCount = edgeSize / 4;
+    if(lookupSize != (quint64)_count * GitOid::Size ||
+       commitDataSize != (quint64)_count * CommitDataSize) {
+        return false;
+    }
+
+    return validateParents();
+}
+
+/**
+ * Every parent position, and every index into the extra edge list, must
+ * lie within the file. Checked once here so that readers need not.
+ */
+bool CommitGraphFile::validateParents() const
+{
+    quint32 count = _count;
+    for(int position = 0;position < _count;position++) {
+        const uchar* data = commitData(position);
+        quint32 parent1 = qFromBigEndian<quint32>(data + GitOid::Size);
+        quint32 parent2 = qFromBigEndian<quint32>(data + GitOid::Size + 4);
+        if(parent1 != NoParent && parent1 >= count) {
+            return false;
+        }
+        if(parent2 == NoParent) {
+            continue;
+        }
+        if(parent2 & ExtraEdgesFlag) {
+            if((parent2 & PositionMask) >= (quint32)_extraEdgeCount) {
+                return false;
+            }
+        }
+        else if(parent2 >= count) {
+            return false;
+        }
+    }
+
+    for(int edge = 0;edge < _extraEdgeCount;edge++) {
+        quint32 value = qFromBigEndian<quint32>(_extraEdges + (edge * 4));
+        if((value & PositionMask) >= count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int CommitGraphFile::positionOf(const ObjectId& objectId) const
+{
+    if(isValid() == false) {
+        return -1;
+    }
+
+    const uchar* raw = objectId.rawData();
+    int lo = raw[0] == 0 ? 0 : qFromBigEndian<quint32>(_fanout + ((raw[0] - 1) * 4));
+    int hi = qFromBigEndian<quint32>(_fanout + (raw[0] * 4));
+    while(lo < hi) {
+        int mid = lo + ((hi - lo) / 2);
+        int cmp = memcmp(raw, _oidLookup + (mid * GitOid::Size), GitOid::Size);
+        if(cmp == 0) {
+            return mid;
+        }
+        if(cmp < 0) {
+            hi = mid;
+        }
+        else {
+            lo = mid + 1;
+        }
+    }
+    return -1;
+}
+
+ObjectId CommitGraphFile::objectIdAt(int position) const
+{
+    return ObjectId(GitOid(_oidLookup + (position * GitOid::Size), GitOid::Size));
+}
+
+ObjectId CommitGraphFile::treeIdAt(int position) const
+{
+    return ObjectId(GitOid(commitData(position), GitOid::Size));
+}
+
+int CommitGraphFile::parentCount(int position) const
+{
+    const uchar* data = commitData(position);
+    quint32 parent1 = qFromBigEndian<quint32>(data + GitOid::Size);
+    quint32 parent2 = qFromBigEndian<quint32>(data + GitOid::Size + 4);
+    if(parent1 == NoParent) {
+        return 0;
+    }
+    if(parent2 == NoParent) {
+        return 1;
+    }
+    if((parent2 & ExtraEdgesFlag) == 0) {
+        return 2;
+    }
+    return parentPositions(position).count();
+}
+
+QList<int> CommitGraphFile::parentPositions(int position) const
+{
+    QList<int> result;
+    const uchar* data = commitData(position);
+    quint32 parent1 = qFromBigEndian<quint32>(data + GitOid::Size);
+    quint32 parent2 = qFromBigEndian<quint32>(data + GitOid::Size + 4);
+    if(parent1 == NoParent) {
+        return result;
+    }
+    result.append(parent1);
+
+    if(parent2 == NoParent) {
+        return result;
+    }
+
+    if((parent2 & ExtraEdgesFlag) == 0) {
+        result.append(parent2);
+        return result;
+    }
+
+    // octopus merge: parents 2..n live in the extra edge list, last one flagged
+    for(int edge = parent2 & PositionMask;edge < _extraEdgeCount;edge++) {
+        quint32 value = qFromBigEndian<quint32>(_extraEdges + (edge * 4));
+        result.append(value & PositionMask);
+        if(value & ExtraEdgesFlag) {
+            break;
+        }
+    }
+    return result;
+}
+
+ObjectId::List CommitGraphFile::parentIdsAt(int position) const
+{
+    ObjectId::List result;
+    QList<int> positions = parentPositions(position);
+    for(int parent : positions) {
+        if(parent < _count) {
+            result.append(objectIdAt(parent));
+        }
+    }
+    return result;
+}
+
+int64_t CommitGraphFile::commitTimeAt(int position) const
+{
+    const uchar* data = commitData(position) + GitOid::Size + 8;
+    quint64 high = qFromBigEndian<quint32>(data) & 0x3;
+    quint64 low = qFromBigEndian<quint32>(data + 4);
+    return (int64_t)((high << 32) | low);
+}
+
+uint32_t CommitGraphFile::generationAt(int position) const
+{
+    const uchar* data = commitData(position) + GitOid::Size + 8;
+    return qFromBigEndian<quint32>(data) >> 2;
+}
+
+QString CommitGraphFile::defaultPath(Repository* repo)
+{
+    return Utility::combine(git_repository_commondir(repo->handle().value()), "objects/info/commit-graph");
+}
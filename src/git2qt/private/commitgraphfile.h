@@ -0,0 +1,82 @@
+#ifndef COMMITGRAPHFILE_H
+#define COMMITGRAPHFILE_H
+#include <git2qt/objectid.h>
+
+#include <QFile>
+
+namespace GIT {
+
+class Repository;
+
+/**
+ * Read-only, memory-mapped view of .git/objects/info/commit-graph.
+ *
+ * Commits are addressed by their position in the file (which is the
+ * sort order of their object ids). Parents, root trees, commit times
+ * and generation numbers can be read by position without inflating
+ * any commit objects.
+ *
+ * Only a single commit-graph file is supported. Split graph chains
+ * (objects/info/commit-graphs) are ignored and callers fall back to the
+ * object database.
+ */
+class CommitGraphFile
+{
+public:
+    CommitGraphFile();
+    ~CommitGraphFile();
+
+    bool load(const QString& path);
+    bool load(Repository* repo) { return load(defaultPath(repo)); }
+    void unload();
+
+    bool isValid() const { return _data != nullptr; }
+    int count() const { return _count; }
+    QString path() const { return _file.fileName(); }
+
+    int positionOf(const ObjectId& objectId) const;
+    ObjectId objectIdAt(int position) const;
+    ObjectId treeIdAt(int position) const;
+    int parentCount(int position) const;
+    QList<int> parentPositions(int position) const;
+    ObjectId::List parentIdsAt(int position) const;
+    int64_t commitTimeAt(int position) const;
+    uint32_t generationAt(int position) const;
+
+    static QString defaultPath(Repository* repo);
+
+    static const uint32_t NoParent = 0x70000000;
+    static const uint32_t ExtraEdgesFlag = 0x80000000;
+    static const uint32_t PositionMask = 0x7fffffff;
+
+private:
+    const uchar* commitData(int position) const { return _commitData + (position * CommitDataSize); }
+    bool findChunks();
+    bool validateParents() const;
+
+    QFile _file;
+    const uchar* _data = nullptr;
+    qint64 _size = 0;
+
+    const uchar* _fanout = nullptr;
+    const uchar* _oidLookup = nullptr;
+    const uchar* _commitData = nullptr;
+    const uchar* _extraEdges = nullptr;
+    int _count = 0;
+    int _extraEdgeCount = 0;
+
+    static const int HeaderSize = 8;
+    static const int ChunkEntrySize = 12;
+    static const int FanoutSize = 256 * 4;
+    static const int CommitDataSize = GitOid::Size + 16;
+
+    static const uint32_t FileSignature = 0x43475048;   // "CGPH"
+    static const uint32_t ChunkFanout = 0x4f494446;    // "OIDF"
+    static const uint32_t ChunkLookup = 0x4f49444c;    // "OIDL"
+    static const uint32_t ChunkCommitData = 0x43444154; // "CDAT"
+    static const uint32_t ChunkExtraEdges = 0x45444745; // "EDGE"
+};
+
+} // namespace GIT
+
+#endif // COMMITGRAPHFILE_H
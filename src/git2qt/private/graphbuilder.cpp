@@ -1,79 +1,340 @@
 #include "graphbuilder.h"
 
 #include "ancestorseeker.h"
+#include "graphlayoutcache.h"
+#include "historysimplifier.h"
 #include "texttable.h"
 
 #include <QElapsedTimer>
+#include <commitlog.h>
 #include <gitexception.h>
 #include <repository.h>
 #include <stash.h>
 #include <utility.h>
 
+#include <limits>
+
 using namespace GIT;
 
 GraphBuilder::GraphBuilder(Repository* repo) :
-    GitEntity(GraphBuilderEntity, repo)
+    GraphBuilder(repo, Snapshot(repo)) {}
+
+GraphBuilder::GraphBuilder(Repository* repo, const Snapshot& snapshot) :
+    GitEntity(GraphBuilderEntity, repo),
+    _snapshot(snapshot),
+    _owner(repo)
+{
+    buildBranchTipIndex();
+}
+
+GraphBuilder::Snapshot::Snapshot(Repository* repo) :
+    _localBranches(repo->localBranches()),
+    _remoteBranches(repo->remoteBranches()),
+    _references(repo->references()),
+    _stashes(repo->stashes())
 {
-    _localBranches = repo->localBranches();
-    _remoteBranches = repo->remoteBranches();
+    Branch headBranch = repo->head();
+    if(headBranch.isNull() == false) {
+        _headTargetId = headBranch.reference().targetObjectId();
+    }
+    _headCommitId = repo->headCommit().objectId();
+    _mostRecentCommitId = repo->mostRecentCommit().objectId();
+    _referenceIds = _references.objectIds();
+
+    // remote branch names are resolved through the repository's configuration
+    QList<Branch> branches = _localBranches.values() + _remoteBranches.values();
+    for(const Branch& branch : branches) {
+        QString canonicalName = branch.reference().canonicalName();
+        _friendlyBranchNames.insert(canonicalName, branch.friendlyName(true));
+        _branchNames.insert(canonicalName, branch.friendlyName(false));
+    }
 }
 
 GraphBuilder::~GraphBuilder()
 {
-    qDeleteAll(_allCommits);
     _allCommits.clear();
+    _arena.clear();
+    if(_privateRepository != nullptr) {
+        delete _privateRepository;
+    }
+}
+
+/**
+ * Calculate on a repository handle of its own rather than the owner's,
+ * since libgit2 objects must not be used from two threads at once. Called
+ * on the thread which runs the calculation. The rows produced are still
+ * bound to the owning repository.
+ */
+bool GraphBuilder::openPrivateRepository(const QByteArray& path)
+{
+    git_repository* repo = nullptr;
+    if(git_repository_open(&repo, path.constData()) != 0) {
+        return false;
+    }
+
+    _privateRepository = new Repository(repo);
+    setRepository(_privateRepository);
+    return _privateRepository->isNull() == false;
 }
 
 bool GraphBuilder::calculateGraph()
 {
+    if(_layoutCachePath.isEmpty() == false) {
+        return calculateCachedGraph();
+    }
+
     bool result = false;
 
     reset();
 
     try
     {
-        Branch headBranch = repository()->head();
-        throwIfTrue(headBranch.isNull(), "Head branch has a null reference");
+        throwIfTrue(_snapshot.headTargetId().isNull(), "Head branch has a null reference");
 
-        Commit headCommit = Commit::lookup(repository(), headBranch.reference().targetObjectId());
+        Commit headCommit = Commit::lookup(repository(), _snapshot.headTargetId());
         throwIfFalse(headCommit.isValid());
 
         // Create the list of all commits in time-order
-        _allCommits = GraphBuilderCommit::PtrList(repository()->allCommits());
+        beginStage(GraphStageWalk);
+        Commit::List commits = walkAllCommits();
+        HistorySimplifier simplifier(repository(), _paths);
+        if(simplifier.hasPaths()) {
+            commits = simplifier.simplify(removeStashes(commits), walkTips());
+            checkCanceled();
+        }
+        else if(_collapsed) {
+            commits = removeStashes(commits);
+        }
+        _allCommits = _arena.create(commits);
 
-        // Create a map for quick lookup
-        _commitIndex = GraphBuilderCommit::Map(_allCommits);
+        // lanes follow the simplified parents
+        if(simplifier.hasPaths()) {
+            for(GraphBuilderCommit* commit : _allCommits) {
+                commit->setParentObjectIds(simplifier.parentIds(commit->objectId()));
+            }
+        }
+        else if(_collapsed) {
+            collapseMerges();
+        }
 
-        // detect stashes and remove their unwanted children from the graph
-        _allCommits.detectStashes(repository());
+        calculateLayout();
 
-        // resolve commit relationships
-        _allCommits.resolveParentsAndChildren();
+        result = true;
+    }
+    catch(const GitException&)
+    {
+        result = false;
+    }
 
-        // resolve merges and stashes
-        _allCommits.resolveMergesAndStashes(repository());
+    return result;
+}
 
-        // resolve branch names
-        _allCommits.resolveBranchNames(this);
+/**
+ * Recalculate the graph starting from a previously calculated one.
+ *
+ * Only commits which are not in the previous graph are walked and looked up,
+ * and merge bases and merge births are carried over for every previous commit.
+ * Branch names, levels and lines are recalculated for the whole list since
+ * lanes are assigned in a single top-down sweep.
+ *
+ * Falls back to a full calculation when history was removed (a previous tip
+ * is no longer reachable) or the stash list changed.
+ */
+bool GraphBuilder::calculateGraph(const GraphedCommit::List& previous)
+{
+    // path-limited and collapsed graphs are simplified as a whole
+    if(previous.isEmpty() || _paths.isEmpty() == false || _collapsed) {
+        return calculateGraph();
+    }
 
-        // resolve the earliest commit for each branch
-        buildBranchFromCommitIndex();
+    bool result = false;
 
-        // resolve merge births
-        resolveMergeBirths();
+    reset();
 
-        // Resolve the levels
-        resolveGraphLevels();
+    try
+    {
+        throwIfTrue(_snapshot.headTargetId().isNull(), "Head branch has a null reference");
+
+        QHash<ObjectId, int> previousIndex;
+        previousIndex.reserve(previous.count());
+        ObjectId::List leaves;
+        ObjectId::Set previousStashes;
+        for(int index = 0;index < previous.count();index++) {
+            const GraphedCommit& commit = previous.at(index);
+            previousIndex.insert(commit.objectId(), index);
+            if(commit.childObjectIds().isEmpty()) {
+                leaves.append(commit.objectId());
+            }
+            if(commit.isStash()) {
+                previousStashes.insert(commit.objectId());
+            }
+        }
 
-        // Do the graphics stuff
-        buildGraphLines();
+        ObjectId::Set currentStashes;
+        for(const Stash& stash : _snapshot.stashes()) {
+            currentStashes.insert(stash.workTree().objectId());
+        }
+        if(currentStashes != previousStashes) {
+            logText(LVL_DEBUG, "Stashes changed, recalculating the full graph");
+            return recalculateGraph();
+        }
 
-        // create the result
-        _graphedCommits = _allCommits.toGraphedCommitList();
+        // Walk only the commits which are not reachable from the previous leaves
+        ObjectId::List tips;
+        tips.append(_snapshot.headCommitId());
+        tips.append(_snapshot.referenceIds());
+
+        CommitFilter filter;
+        filter.setIncludeReachableFrom(tips);
+        filter.setExcludeReachableFromRefs(leaves);
+        filter.setSortBy(SortStrategyTime | SortStrategyTopological);
+
+        beginStage(GraphStageWalk);
+        CommitLog commitLog(repository(), filter);
+        if(commitLog.open() == false) {
+            logText(LVL_DEBUG, "Previous graph is not walkable, recalculating the full graph");
+            return recalculateGraph();
+        }
+        Commit::List newCommits = commitLog.fetchNext(std::numeric_limits<int>::max());
+        if(commitLog.hasFailed()) {
+            return recalculateGraph();
+        }
 
-        // clean up
-        qDeleteAll(_allCommits);
-        _allCommits.clear();
+        // Every previous leaf must still be reachable from a tip, a stash or a new commit
+        ObjectId::Set reachable = currentStashes;
+        for(const ObjectId& tip : tips) {
+            reachable.insert(previousIndex.contains(tip) ? tip : peelToCommit(tip));
+        }
+        for(const Commit& commit : newCommits) {
+            for(const ObjectId& parentId : commit.parentIds()) {
+                reachable.insert(parentId);
+            }
+        }
+        for(const ObjectId& leaf : leaves) {
+            if(reachable.contains(leaf) == false) {
+                logText(LVL_DEBUG, "History was removed, recalculating the full graph");
+                return recalculateGraph();
+            }
+        }
+
+        // New commits are never ancestors of previous ones, so they all go on top
+        _allCommits = _arena.create(newCommits);
+        _allCommits.reserve(newCommits.count() + previous.count());
+        for(const GraphedCommit& commit : previous) {
+            GraphBuilderCommit* builderCommit = _arena.create(commit);
+            builderCommit->resetLayout();
+            _allCommits.append(builderCommit);
+        }
+
+        calculateLayout();
+
+        result = true;
+    }
+    catch(const GitException&)
+    {
+        result = false;
+    }
+
+    return result;
+}
+
+/**
+ * Fall back from an incremental calculation to a full one. reset() starts
+ * the statistics over, so the time already spent on the incremental walk is
+ * carried into the statistics of the full calculation.
+ */
+bool GraphBuilder::recalculateGraph()
+{
+    GraphBuildStatistics attempted = _statistics;
+    if(_stageTimer.isValid()) {
+        attempted.addStage(_stage, _stageTimer.nsecsElapsed());
+        _stageTimer.invalidate();
+    }
+
+    bool result = calculateGraph();
+    _statistics.merge(attempted);
+    return result;
+}
+
+/**
+ * Answer the cached graph when no reference or stash changed since it was
+ * written. Otherwise extend it with the new commits (which recalculates from
+ * scratch when history was rewritten) and store the result for next time.
+ */
+bool GraphBuilder::calculateCachedGraph()
+{
+    // the calculations below must not come back here
+    GraphLayoutCache cache(_layoutCachePath);
+    _layoutCachePath.clear();
+
+    bool result = false;
+
+    try
+    {
+        QByteArray key = GraphLayoutCache::currentKey(_snapshot.references(), _snapshot.stashes());
+        GraphedCommit::List cached;
+        if(cache.read(repository(), cached, _owner) && cache.key() == key) {
+            reset();
+            _graphedCommits = cached;
+            beginStage(GraphStageComplete);
+            result = true;
+        }
+        else if((result = calculateGraph(cached)) == true) {
+            cache.write(_graphedCommits, key);
+        }
+    }
+    catch(const GitException&)
+    {
+        result = false;
+    }
+
+    _layoutCachePath = cache.path();
+    return result;
+}
+
+/**
+ * Lay out just the commits a merge brought in: those reachable from its
+ * second and later parents but not from its first. Used to expand a merge
+ * of a collapsed graph without laying out the rest of the history.
+ */
+bool GraphBuilder::calculateMergedGraph(const ObjectId& mergeId)
+{
+    bool result = false;
+
+    reset();
+
+    try
+    {
+        Commit mergeCommit = Commit::lookup(repository(), mergeId);
+        throwIfFalse(mergeCommit.isValid() && mergeCommit.parentIds().count() > 1, "Not a merge commit");
+
+        ObjectId::List parentIds = mergeCommit.parentIds();
+        CommitFilter filter;
+        filter.setIncludeReachableFrom(parentIds.mid(1));
+        filter.setExcludeReachableFromRefs(parentIds.first());
+        filter.setSortBy(SortStrategyTime | SortStrategyTopological);
+
+        beginStage(GraphStageWalk);
+        CommitLog commitLog(repository(), filter);
+        throwIfFalse(commitLog.open(), "Failed to open the commit log");
+        Commit::List commits = commitLog.fetchNext(std::numeric_limits<int>::max());
+        throwIfTrue(commitLog.hasFailed(), "Failed to walk the commit log");
+
+        _allCommits = _arena.create(commits);
+
+        // parents outside the merged commits are not part of this graph
+        ObjectId::Set merged(commits.objectIds());
+        for(GraphBuilderCommit* commit : _allCommits) {
+            ObjectId::List parents;
+            for(const ObjectId& parentId : commit->parentIds()) {
+                if(merged.contains(parentId)) {
+                    parents.append(parentId);
+                }
+            }
+            commit->setParentObjectIds(parents);
+        }
+
+        calculateLayout();
 
         result = true;
     }
@@ -91,26 +352,25 @@ void GraphBuilder::ancestorTest(const ObjectId &commitId)
 
     try
     {
-        Branch headBranch = repository()->head();
-        throwIfTrue(headBranch.isNull(), "Head branch has a null reference");
+        throwIfTrue(_snapshot.headTargetId().isNull(), "Head branch has a null reference");
 
-        Commit headCommit = Commit::lookup(repository(), headBranch.reference().targetObjectId());
+        Commit headCommit = Commit::lookup(repository(), _snapshot.headTargetId());
         throwIfFalse(headCommit.isValid());
 
         // Create the list of all commits in time-order
-        _allCommits = GraphBuilderCommit::PtrList(repository()->allCommits());
+        _allCommits = _arena.create(repository()->allCommits());
 
         // Create a map for quick lookup
         _commitIndex = GraphBuilderCommit::Map(_allCommits);
 
         // detect stashes and remove their unwanted children from the graph
-        _allCommits.detectStashes(repository());
+        _allCommits.detectStashes(_snapshot.stashes());
 
         // resolve commit relationships
-        _allCommits.resolveParentsAndChildren();
+        _allCommits.resolveParentsAndChildren(_arena);
 
         // resolve merges and stashes
-        _allCommits.resolveMergesAndStashes(repository());
+        _allCommits.resolveMergesAndStashes(this, _snapshot.stashes());
 
 
         GraphBuilderCommit* mergeCommit = _commitIndex.value(commitId);
@@ -121,8 +381,8 @@ void GraphBuilder::ancestorTest(const ObjectId &commitId)
         Q_UNUSED(seeker)
 
         // clean up
-        qDeleteAll(_allCommits);
         _allCommits.clear();
+        _arena.clear();
     }
     catch(const GitException&)
     {
@@ -131,9 +391,11 @@ void GraphBuilder::ancestorTest(const ObjectId &commitId)
 
 Branch GraphBuilder::findBranchForReferencedObjectId(const ObjectId& objectId) const
 {
+    // Prefer remote branches, then local, as the first match in name order
     Branch branch;
-    if((branch = _remoteBranches.findForReferencedObjectId(objectId)).isValid() == false) {
-        branch = _localBranches.findForReferencedObjectId(objectId);
+    auto it = _branchTips.constFind(objectId);
+    if(it != _branchTips.constEnd()) {
+        branch = it.value().first();
     }
     return branch;
 }
@@ -190,59 +452,304 @@ void GraphBuilder::dumpCommitTable(const GraphBuilderCommit::PtrList& table)
 
 void GraphBuilder::reset()
 {
-    qDeleteAll(_allCommits);
     _allCommits.clear();
+    _arena.clear();
     _commitIndex.clear();
+    _levelMap = GraphLevelMap();
+    _branchBirths.clear();
     _mergeBirths.clear();
+    _mergeParents.clear();
+    _graphedCommits.clear();
+    _graphLayout = GraphLayout();
+    _statistics = GraphBuildStatistics();
+    _statistics.begin();
+    _stageTimer.invalidate();
+    buildBranchTipIndex();
+}
+
+void GraphBuilder::buildBranchTipIndex()
+{
+    _branchTips.clear();
+    _branchTips.reserve(_snapshot.remoteBranches().count() + _snapshot.localBranches().count());
+    for(const Branch& branch : _snapshot.remoteBranches()) {
+        _branchTips[branch.reference().objectId()].append(branch);
+    }
+    for(const Branch& branch : _snapshot.localBranches()) {
+        _branchTips[branch.reference().objectId()].append(branch);
+    }
+}
+
+void GraphBuilder::calculateLayout()
+{
+    // Create a map for quick lookup
+    _commitIndex = GraphBuilderCommit::Map(_allCommits);
+
+    // detect stashes and remove their unwanted children from the graph
+    beginStage(GraphStageStashes);
+    _allCommits.detectStashes(_snapshot.stashes());
+
+    // resolve commit relationships
+    beginStage(GraphStageLinking);
+    _allCommits.resolveParentsAndChildren(_arena);
+
+    // resolve merges and stashes
+    beginStage(GraphStageMerges);
+    _allCommits.resolveMergesAndStashes(this, _snapshot.stashes());
+
+    // resolve branch names
+    beginStage(GraphStageBranchNames);
+    _allCommits.resolveBranchNames(this);
+
+    // resolve the earliest commit for each branch
+    buildBranchFromCommitIndex();
+
+    // resolve merge births
+    beginStage(GraphStageLevels);
+    resolveMergeBirths();
+
+    // Resolve the levels
+    resolveGraphLevels();
+
+    // Do the graphics stuff
+    beginStage(GraphStageLines);
+    buildGraphLines();
+
+    // create the result
+    _graphedCommits = toGraphedCommitList();
+
+    // clean up
+    _allCommits.clear();
+    _arena.clear();
+
+    beginStage(GraphStageComplete);
+}
+
+/**
+ * Same walk as Repository::allCommits(), fetched in batches so that
+ * an asynchronous calculation can be canceled part way through and
+ * can publish its preview before the rest of history is looked up.
+ */
+Commit::List GraphBuilder::walkAllCommits()
+{
+    CommitFilter filter;
+    filter.setIncludeReachableFrom(walkTips());
+    filter.setSortBy(SortStrategyTime | SortStrategyTopological);
+    filter.setFirstParentOnly(_collapsed && _paths.isEmpty());
+
+    // the preview is laid out as soon as its commits have been fetched
+    bool previewPending = _promise != nullptr && _previewCount > 0 && _paths.isEmpty() && _collapsed == false;
+
+    Commit::List result;
+    CommitLog commitLog(repository(), filter);
+    throwIfFalse(commitLog.open(), "Failed to open the commit log");
+    while(commitLog.canFetchMore()) {
+        result.append(commitLog.fetchNext(previewPending ? _previewCount - result.count() : WalkBatchSize));
+        checkCanceled();
+        if(previewPending && result.count() >= _previewCount) {
+            if(commitLog.canFetchMore()) {
+                publishPreview(result);
+            }
+            previewPending = false;
+        }
+    }
+    throwIfTrue(commitLog.hasFailed(), "Failed to walk the commit log");
+    return result;
+}
+
+ObjectId::List GraphBuilder::walkTips() const
+{
+    ObjectId::List result;
+    result.append(_snapshot.headCommitId());
+    result.append(_snapshot.mostRecentCommitId());
+    result.append(_snapshot.referenceIds());
+    return result;
+}
+
+/**
+ * Stashes are left out of path-limited and collapsed graphs
+ */
+Commit::List GraphBuilder::removeStashes(const Commit::List& commits) const
+{
+    ObjectId::Set stashIds;
+    for(const Stash& stash : _snapshot.stashes()) {
+        stashIds.insert(stash.workTree().objectId());
+        stashIds.insert(stash.indexId());
+        stashIds.insert(stash.untrackedId());
+    }
+
+    Commit::List result;
+    result.reserve(commits.count());
+    for(const Commit& commit : commits) {
+        if(stashIds.contains(commit.objectId()) == false) {
+            result.append(commit);
+        }
+    }
+    return result;
+}
+
+/**
+ * In a collapsed graph every row keeps only its first parent, and each merge
+ * is marked as collapsed with the number of commits it brought in: those
+ * reachable from its second and later parents but not from its first.
+ * The counts are walked here, on the calculating thread, so that the rows
+ * handed to a view need nothing more from the repository.
+ */
+void GraphBuilder::collapseMerges()
+{
+    ObjectId::Set walked;
+    walked.reserve(_allCommits.count());
+    for(GraphBuilderCommit* commit : _allCommits) {
+        walked.insert(commit->objectId());
+    }
+
+    for(GraphBuilderCommit* commit : _allCommits) {
+        ObjectId::List parentIds = commit->parentIds();
+        ObjectId::List firstParent;
+        if(parentIds.count() > 0 && walked.contains(parentIds.first())) {
+            firstParent.append(parentIds.first());
+        }
+        commit->setParentObjectIds(firstParent);
+        commit->setCollapsed(parentIds.count() > 1);
+        if(parentIds.count() > 1) {
+            commit->setCollapsedCount(countMergedCommits(parentIds));
+            checkCanceled();
+        }
+    }
+}
+
+/**
+ * The commits reachable from the second and later parents of a merge but not
+ * from its first. Commits are counted, not looked up.
+ */
+int GraphBuilder::countMergedCommits(const ObjectId::List& mergeParentIds) const
+{
+    CommitFilter filter;
+    filter.setIncludeReachableFrom(mergeParentIds.mid(1));
+    filter.setExcludeReachableFromRefs(mergeParentIds.first());
+
+    CommitLog commitLog(repository(), filter);
+    return commitLog.open() ? commitLog.skip(std::numeric_limits<int>::max()) : 0;
+}
+
+/**
+ * Lay out just the top of history and hand it to the promise, so a view can
+ * draw its first screen while the rest of the graph is calculated. Parents
+ * beyond the preview are simply missing, so lanes near the bottom of the
+ * preview may differ from the final result.
+ */
+void GraphBuilder::publishPreview(const Commit::List& commits)
+{
+    if(_promise == nullptr) {
+        return;
+    }
+
+    GraphBuilder preview(repository(), _snapshot);
+    preview._owner = _owner;
+    preview._allCommits = preview._arena.create(commits);
+    preview.calculateLayout();
+    _promise->addResult(preview.graphedCommits());
+}
+
+void GraphBuilder::beginStage(GraphBuildStage stage)
+{
+    checkCanceled();
+
+    // the previous stage ends where this one begins
+    if(_stageTimer.isValid()) {
+        _statistics.addStage(_stage, _stageTimer.nsecsElapsed());
+        _stageTimer.invalidate();
+    }
+    _stage = stage;
+    if(stage == GraphStageComplete) {
+        _statistics._commitCount = _graphedCommits.count();
+    }
+    else {
+        _stageTimer.start();
+    }
+
+    if(_promise != nullptr) {
+        _promise->setProgressValueAndText(stage, getGraphBuildStageString(stage));
+    }
+}
+
+GraphedCommit::List GraphBuilder::toGraphedCommitList()
+{
+    GraphedCommit::List result;
+    result.reserve(_allCommits.count());
+    for(int index = 0;index < _allCommits.count();index++) {
+        if((index % CancelCheckInterval) == 0) {
+            checkCanceled();
+        }
+
+        // rows outlive a private repository handle
+        GraphBuilderCommit* commit = _allCommits.at(index);
+        commit->setOwner(_owner);
+        result.append(commit->toGraphedCommit());
+    }
+    return result;
+}
+
+void GraphBuilder::checkCanceled() const
+{
+    if(isCanceled()) {
+        throw GitException("Graph calculation canceled");
+    }
+}
+
+ObjectId GraphBuilder::peelToCommit(const ObjectId& objectId) const
+{
+    ObjectId result;
+    git_object* obj = nullptr;
+    git_object* peeled = nullptr;
+    if(git_object_lookup(&obj, repository()->handle().value(), objectId.toNative(), GIT_OBJECT_ANY) == 0 &&
+       git_object_peel(&peeled, obj, GIT_OBJECT_COMMIT) == 0) {
+        result = ObjectId(peeled);
+    }
+    git_object_free(peeled);
+    git_object_free(obj);
+    return result;
 }
 
 void GraphBuilder::resolveGraphLevels()
 {
     for(int index = 0;index < _allCommits.count();index++) {
         GraphBuilderCommit* commit = _allCommits.at(index);
+        if((index % CancelCheckInterval) == 0) {
+            checkCanceled();
+        }
 
-        // clean up levels that are no longer needed
-        ObjectId::List mergeIds = _levelMap.mergeIds();
-        for(const ObjectId& objectId : mergeIds) {
-            GraphBuilderCommit* mergeBirth = _mergeBirths.value(objectId);
-            if(mergeBirth == commit) {
+        // clean up levels of merges which were born at this commit
+        GraphBuilderCommit::PtrList mergeChildren = _mergeParents.value(commit->objectId());
+        for(GraphBuilderCommit* mergeChild : mergeChildren) {
+            GraphLevelMap::Owner mergeOwner = GraphLevelMap::mergeOwner(mergeChild->index());
+            GraphLevelMap::Owner mergeSourceOwner = GraphLevelMap::mergeSourceOwner(mergeChild->index());
+            if(_levelMap.containsOwner(mergeOwner) || _levelMap.containsOwner(mergeSourceOwner)) {
                 // blow away the old level
-                int levelToRemove = _levelMap.levelForName(objectId.toString());
-                QString mergeSourceString = GraphLevelMap::makeMergeSourceString(objectId);
-                _levelMap.removeLevel(mergeSourceString);
-                _levelMap.removeLevel(objectId.toString());
+                int levelToRemove = _levelMap.levelForOwner(mergeOwner);
+                _levelMap.removeOwner(mergeSourceOwner);
+                _levelMap.removeOwner(mergeOwner);
                 _levelMap.removeLevel(levelToRemove);
 
                 // If we are a merge at the same level we just blew away
                 if(commit->isMerge() && commit->level() == levelToRemove && _levelMap.containsLevel(commit->level()) == false) {
-                    _levelMap.addLevel(commit->objectId().toString(), commit->level());
+                    _levelMap.addLevel(GraphLevelMap::mergeOwner(commit->index()), commit->level());
                 }
             }
         }
 
         QStringList branchBirths = _branchBirths.value(commit->objectId());
         for(const QString& branchName : branchBirths) {
-            _levelMap.removeLevel(branchName);
-        }
-
-
-        // -------------------- BEGIN I think this is unreachable code
-        GraphBuilderCommit::PtrList mergeChildren = _mergeParents[commit->objectId()];
-        for(GraphBuilderCommit* mergeChild : mergeChildren) {
-            if(_levelMap.containsName(mergeChild->objectId().toString())) {
-                _levelMap.removeLevel(mergeChild->objectId().toString());
-            }
+            _levelMap.removeOwner(_levelMap.branchOwner(branchName));
         }
-        // -------------------- END I think this is unreachable code
 
         if(commit->level() == 0) {
             int level = _levelMap.availableLevel();
             commit->setLevel(level);
             if(commit->isMerge()) {
-                _levelMap.addLevel(commit->objectId().toString(), commit->level());
+                _levelMap.addLevel(GraphLevelMap::mergeOwner(commit->index()), commit->level());
             }
             else {
-                _levelMap.addLevel(commit->friendlyBranchName(), level);
+                _levelMap.addLevel(_levelMap.branchOwner(commit->friendlyBranchName()), level);
             }
             resolveParentLevels(commit);
         }
@@ -262,36 +769,33 @@ if(commit->objectId().sha().startsWith("452b7")) {
     if(commit->isMerge()) {
         // Merge base is on the same level as this commit
         GraphBuilderCommit* mergeBaseCommit = _commitIndex.value(commit->mergeBase());
-        if(mergeBaseCommit->level() == 0) {
+        if(mergeBaseCommit != nullptr && mergeBaseCommit->level() == 0) {
             mergeBaseCommit->setLevel(commit->level());
-            _levelMap.addLevel(commit->objectId().toString(), commit->level());
-            // if(_levelMap.containsLevel(commit->level()) == false) {
-            //     _levelMap.addLevel(commit->objectId().toString(), commit->level());
-            // }
+            _levelMap.addLevel(GraphLevelMap::mergeOwner(commit->index()), commit->level());
         }
 
         // Merge from gets a new level
         GraphBuilderCommit* mergeFromCommit = _commitIndex.value(commit->mergeFrom());
-        if(mergeFromCommit->level() == 0) {
+        if(mergeFromCommit != nullptr && mergeFromCommit->level() == 0) {
             int level = _levelMap.availableLevel();
             if(mergeFromCommit->isMerge()) {
-                _levelMap.addLevel(mergeFromCommit->objectId().toString(), level);
+                _levelMap.addLevel(GraphLevelMap::mergeOwner(mergeFromCommit->index()), level);
             }
             else {
-                _levelMap.addLevel(GraphLevelMap::makeMergeSourceString(commit->objectId()), level);
+                _levelMap.addLevel(GraphLevelMap::mergeSourceOwner(commit->index()), level);
             }
             mergeFromCommit->setLevel(level);
         }
     }
-    else if(commit->parentCommitsRef().count() == 1) {
+    else if(commit->parentCommits().count() == 1) {
         // If only a single parent, we will probably use this commit level for the parent
-        GraphBuilderCommit* parent = commit->parentCommitsRef().at(0);
+        GraphBuilderCommit* parent = commit->parentCommits().at(0);
         // set future single parents level
         while(parent->level() == 0) {
             parent->setLevel(commit->level());
-            if(parent->parentCommitsRef().count() == 1 && parent->childCommitsRef().count() == 1) {
-                parent = parent->parentCommitsRef().at(0);
-                if(parent->childCommitsRef().count() > 1 || parent->parentCommitsRef().count() > 1) {
+            if(parent->parentCommits().count() == 1 && parent->childCommits().count() == 1) {
+                parent = parent->parentCommits().at(0);
+                if(parent->childCommits().count() > 1 || parent->parentCommits().count() > 1) {
                     break;
                 }
             }
@@ -301,14 +805,14 @@ if(commit->objectId().sha().startsWith("452b7")) {
         }
 
 #if ATTEMPT_2
-            if(parent->childCommitsRef().count() < 3) {
+            if(parent->childCommits().count() < 3) {
                 parent->setLevel(commit->level());
             }
             else {
                 // In the case that there are more than two children of the parent,
                 // Find the child of the parent (other than this commit) who has a level
                 // Set and use that
-                GraphBuilderCommit::PtrList parentChildren = parent->childCommitsRef();
+                GraphBuilderCommit::PtrList parentChildren = parent->childCommits().toPtrList();
                 parentChildren.removeAll(commit);
                 for(GraphBuilderCommit* child : parentChildren) {
                     if(child->level() != 0) {
@@ -325,7 +829,7 @@ if(commit->objectId().sha().startsWith("452b7")) {
 #endif
     }
     else {
-        for(GraphBuilderCommit* parent :  commit->parentCommitsRef()) {
+        for(GraphBuilderCommit* parent :  commit->parentCommits()) {
             setCommitLevel(commit, parent);
         }
     }
@@ -340,13 +844,14 @@ int GraphBuilder::setCommitLevel(GraphBuilderCommit* parent, GraphBuilderCommit*
         return level;
     }
 
-    if(_levelMap.containsName(child->friendlyBranchName())) {
-        level = _levelMap.levelForName(child->friendlyBranchName());
+    GraphLevelMap::Owner branchOwner = _levelMap.branchOwner(child->friendlyBranchName());
+    if(_levelMap.containsOwner(branchOwner)) {
+        level = _levelMap.levelForOwner(branchOwner);
         child->setLevel(level);
     }
     else if(_branchBirths.contains(child->objectId()) == false) {
         level = _levelMap.availableLevel();
-        _levelMap.addLevel(child->friendlyBranchName(), level);
+        _levelMap.addLevel(branchOwner, level);
         child->setLevel(level);
     }
     else {
@@ -362,14 +867,18 @@ void GraphBuilder::buildBranchFromCommitIndex()
     _branchBirths.clear();
     _mergeBirths.clear();
     for(int index = _allCommits.count() - 1;index >= 0;index--) {
+        if((index % CancelCheckInterval) == 0) {
+            checkCanceled();
+        }
+
         // Detect Branch Birth
         GraphBuilderCommit* commit = _allCommits.at(index);
-        if(commit->parentCommitsRef().count() == 0) {
+        if(commit->parentCommits().count() == 0) {
             _branchBirths.insert(commit->objectId(), QStringList() << commit->friendlyBranchName());
             processedBranches.append(commit->friendlyBranchName());
         }
 
-        for(GraphBuilderCommit* childCommit : commit->childCommitsRef()) {
+        for(GraphBuilderCommit* childCommit : commit->childCommits()) {
             if(childCommit->friendlyBranchName() != commit->friendlyBranchName()) {
                 if(processedBranches.contains(childCommit->friendlyBranchName()) == false) {
                     _branchBirths[commit->objectId()].append(childCommit->friendlyBranchName());
@@ -383,167 +892,67 @@ void GraphBuilder::buildBranchFromCommitIndex()
 
 void GraphBuilder::resolveMergeBirths()
 {
+    MergeBirthSeeker seeker(_allCommits, _commitIndex);
     for(GraphBuilderCommit* commit : _allCommits) {
         // Detect Merge Births
         if(commit->isMerge()) {
-            MergeBaseSeeker seeker(commit, _commitIndex);
-            if(seeker.birthCommit() != nullptr) {
-                _mergeBirths.insert(commit->objectId(), seeker.birthCommit());
-                _mergeParents[seeker.birthCommit()->objectId()].append(commit);
+            checkCanceled();
+
+            // carried over from a previous graph?
+            GraphBuilderCommit* birthCommit = commit->mergeBirth().isValid() ? _commitIndex.value(commit->mergeBirth()) : nullptr;
+            if(birthCommit == nullptr) {
+                birthCommit = seeker.findBirthCommit(commit);
+            }
+            if(birthCommit != nullptr) {
+                commit->setMergeBirth(birthCommit->objectId());
+                _mergeBirths.insert(commit->objectId(), birthCommit);
+                _mergeParents[birthCommit->objectId()].append(commit);
             }
 
         }
     }
 }
 
-void GraphBuilder::buildGraphLines()
+void GraphBuilder::buildGraphLayout()
 {
-    for(int index = 0;index < _allCommits.count();index++) {
-        GraphBuilderCommit* commit = _allCommits.at(index);
-
-if(commit->objectId().sha().startsWith("e067")) {
-    logText(LVL_DEBUG, "Here");
-}
-
-        // Always a dot at level
-        GraphLine& thisLine = commit->graphLineRef();
-        if(commit->isMerge()) {
-            thisLine.setGraphItem(commit->level(), MergeDot | VerticalDown);
-        }
-        else {
-            thisLine.setGraphItem(commit->level(), CommitDot | VerticalDown);
+    _graphLayout = GraphLayout();
+    for(GraphBuilderCommit* commit : _allCommits) {
+        QList<int> parentRows;
+        for(GraphBuilderCommit* parent : commit->parentCommits()) {
+            parentRows.append(parent->index());
         }
 
-        // If a merge, we will also go down and left-or-right
+        int mergeFromRow = GraphLayout::NoRow;
+        int mergeBaseRow = GraphLayout::NoRow;
         if(commit->isMerge()) {
             GraphBuilderCommit* mergeFromCommit = _commitIndex.value(commit->mergeFrom());
-            drawMergeLine(commit, mergeFromCommit, mergeFromCommit->level());
-
+            if(mergeFromCommit != nullptr) {
+                mergeFromRow = mergeFromCommit->index();
+            }
             GraphBuilderCommit* mergeBaseCommit = _commitIndex.value(commit->mergeBase());
-            drawMergeLine(commit, mergeBaseCommit, commit->level());
-        }
-        else {
-            for(GraphBuilderCommit* parent : commit->parentCommitsRef()) {
-                // draw verticals from this down to parent - 1
-                for(int lineIndex = index + 1;lineIndex < parent->index();lineIndex++) {
-                    GraphBuilderCommit* nextCommit = _allCommits.at(lineIndex);
-                    int lineLevel = 0;
-                    if(commit->isMerge()) {
-                        lineLevel = parent->level();
-                    }
-                    else {
-                        lineLevel = commit->level();
-                    }
-                    nextCommit->graphLineRef().setGraphItem(lineLevel, VerticalUp | VerticalDown);
-                }
-
-                // draw curves and horizontals at the parent
-                if(commit->isMerge() == false) {
-                    if(parent->level() == commit->level()) {
-                        parent->graphLineRef().setGraphItem(commit->level(), VerticalUp);
-                    }
-                    else if(parent->level() < commit->level()) {
-                        parent->graphLineRef().setGraphItem(commit->level(), DownToLeft);
-                        if(parent->level() < commit->level() - 1) {
-                            parent->graphLineRef().setGraphItem(parent->level(), HorizontalRight);
-                        }
-
-                        for(int level = parent->level() + 1;level < commit->level();level++) {
-                            parent->graphLineRef().setGraphItem(level, HorizontalLeft);
-                            if(level < commit->level() - 1) {
-                                parent->graphLineRef().setGraphItem(level, HorizontalRight);
-                            }
-                        }
-                    }
-                    else if(parent->level() > commit->level()) {
-                        parent->graphLineRef().setGraphItem(commit->level(), DownToRight);
-                        if(commit->level() < parent->level() - 1) {
-                            parent->graphLineRef().setGraphItem(parent->level(), HorizontalLeft);
-                        }
-                        for(int level = commit->level() + 1;level < parent->level();level++) {
-                            parent->graphLineRef().setGraphItem(level, HorizontalRight);
-                            if(level > commit->level() + 1) {
-                                parent->graphLineRef().setGraphItem(level, HorizontalLeft);
-                            }
-                        }
-                    }
-                }
-                else {
-                    if(parent->level() == commit->level()) {
-                        parent->graphLineRef().setGraphItem(commit->level(), VerticalUp);
-                    }
-                    else {
-                        parent->graphLineRef().setGraphItem(parent->level(), VerticalUp);
-                    }
-                }
+            if(mergeBaseCommit != nullptr) {
+                mergeBaseRow = mergeBaseCommit->index();
             }
         }
+        _graphLayout.addRow(commit->level(), commit->isMerge(), mergeFromRow, mergeBaseRow, parentRows);
     }
+    _graphLayout.buildIndex();
 }
 
-GraphItemType GraphBuilder::drawMergeLine(GraphBuilderCommit* commit, GraphBuilderCommit* toCommit, int lineLevel)
-{
-    GraphItemType direction;
-
-    // draw first row horizontal stuff
-    if(lineLevel > commit->level()) {
-        direction = RightThenDown;
-        drawHorizontal(commit, commit->level(), lineLevel - 1);
-        commit->graphLineRef().setGraphItem(lineLevel - 1, RightThenDown);
-    }
-    else if(lineLevel < commit->level()) {
-        direction = LeftThenDown;
-        drawHorizontal(commit, commit->level(), lineLevel + 1);
-        commit->graphLineRef().setGraphItem(lineLevel + 1, LeftThenDown);
-    }
-    else {
-        direction = VerticalDown;
-        commit->graphLineRef().setGraphItem(commit->level(), VerticalDown);
-    }
-
-    // draw verticals
-    for(int lineIndex = commit->index() + 1;lineIndex < toCommit->index();lineIndex++) {
-        GraphBuilderCommit* nextCommit = _allCommits.at(lineIndex);
-        nextCommit->graphLineRef().setGraphItem(lineLevel, VerticalUp | VerticalDown);
-    }
-
-    if(lineLevel != toCommit->level()) {
-        // draw last row horizontal stuff
-        if(toCommit->level() > commit->level()) {
-            drawHorizontal(toCommit, commit->level() + 1, toCommit->level());
-            toCommit->graphLineRef().setGraphItem(lineLevel, DownToRight);
-        }
-        else if(toCommit->level() < commit->level()) {
-            drawHorizontal(toCommit, commit->level() - 1, toCommit->level());
-            toCommit->graphLineRef().setGraphItem(lineLevel, DownToLeft);
-        }
-        else {
-            toCommit->graphLineRef().setGraphItem(commit->level(), VerticalUp);
-        }
-    }
-    else {
-        toCommit->graphLineRef().setGraphItem(toCommit->level(), VerticalUp);
-    }
-
-    return direction;
-}
-
-void GraphBuilder::drawHorizontal(GraphBuilderCommit* commit, int fromLevel, int toLevel)
+void GraphBuilder::buildGraphLines()
 {
-    int from = qMin(fromLevel, toLevel);
-    int to = qMax(fromLevel, toLevel);
-
-    if(to == from) {
+    buildGraphLayout();
+    if(_lazyGraphLines) {
         return;
     }
 
-    // draw end half-lines
-    commit->graphLineRef().setGraphItem(from, HorizontalRight);
-    commit->graphLineRef().setGraphItem(to, HorizontalLeft);
-
-    // draw horizontal as needed
-    for(int level = from + 1;level < to;level++) {
-        commit->graphLineRef().setGraphItem(level, HorizontalRight | HorizontalLeft);
+    // Draw every row, a window at a time so cancellation stays responsive
+    for(int firstRow = 0;firstRow < _allCommits.count();firstRow += CancelCheckInterval) {
+        checkCanceled();
+        GraphLine::List lines = _graphLayout.graphLines(firstRow, CancelCheckInterval);
+        for(int i = 0;i < lines.count();i++) {
+            _allCommits.at(firstRow + i)->setGraphLine(lines.at(i));
+        }
     }
 }
 
@@ -4,6 +4,14 @@
 #include <git2qt/private/graphbuildercommit.h>
 #include <git2qt/private/graphlevelmap.h>
 #include <git2qt/branch.h>
+#include <git2qt/graphlayout.h>
+#include <git2qt/graphbuildstatistics.h>
+#include <git2qt/reference.h>
+#include <git2qt/stash.h>
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QPromise>
 
 namespace GIT {
 class Repository;
@@ -15,12 +23,38 @@ public:
     virtual ~GraphBuilder();
 
     bool calculateGraph();
+    bool calculateGraph(const GraphedCommit::List& previous);
+    bool calculateMergedGraph(const ObjectId& mergeId);
+
+    // Asynchronous calculation support
+    void setPromise(QPromise<GraphedCommit::List>* value) { _promise = value; }
+    void setPreviewCount(int value) { _previewCount = value; }
+    bool openPrivateRepository(const QByteArray& path);
+    bool isCanceled() const { return _promise != nullptr && _promise->isCanceled(); }
+    void checkCanceled() const;
+
+    // Limit the graph to commits which change these paths, with parents rewritten like `git log -- <paths>`
+    void setPaths(const QStringList& value) { _paths = value; }
+
+    // Follow first parents only and fold the commits each merge brought in into a count on the merge
+    void setCollapsed(bool value) { _collapsed = value; }
+
+    // When set, calculateGraph() starts from the graph cached in this file and stores its result there
+    void setLayoutCachePath(const QString& value) { _layoutCachePath = value; }
+
+    // When set, rows get no GraphLine and views draw them from graphLayout()
+    void setLazyGraphLines(bool value) { _lazyGraphLines = value; }
+    GraphLayout graphLayout() const { return _graphLayout; }
+    GraphBuildStatistics statistics() const { return _statistics; }
     void ancestorTest(const ObjectId& commitId);
 
     GraphedCommit::List graphedCommits() const { return _graphedCommits; }
     Branch findBranchForReferencedObjectId(const ObjectId& objectId) const;
-    Branch::Map& localBranches() { return _localBranches; }
-    Branch::Map& remoteBranches() { return _remoteBranches; }
+    Branch::List findBranchesForReferencedObjectId(const ObjectId& objectId) const { return _branchTips.value(objectId); }
+    const Branch::Map& localBranches() const { return _snapshot.localBranches(); }
+    const Branch::Map& remoteBranches() const { return _snapshot.remoteBranches(); }
+    QString friendlyBranchName(const Branch& branch) const { return _snapshot.friendlyBranchName(branch); }
+    QString branchName(const Branch& branch) const { return _snapshot.branchName(branch); }
     GraphBuilderCommit* findCommit(const ObjectId& objectId) const;
 
     virtual bool isNull() const override { return repository() != nullptr; }
@@ -28,17 +62,71 @@ public:
     void dumpCommitTable(const GraphBuilderCommit::PtrList& table);
 
 private:
+    /**
+     * The references, branches and stashes a calculation works from. Taken
+     * on the thread which creates the builder, so that an asynchronous
+     * calculation never reads them while the repository reloads them.
+     */
+    class Snapshot
+    {
+    public:
+        Snapshot() {}
+        Snapshot(Repository* repo);
+
+        const Branch::Map& localBranches() const { return _localBranches; }
+        const Branch::Map& remoteBranches() const { return _remoteBranches; }
+        const Reference::List& references() const { return _references; }
+        const Stash::List& stashes() const { return _stashes; }
+
+        // Branch::friendlyName(true) and friendlyName(false) by canonical name, which read the repository
+        QString friendlyBranchName(const Branch& branch) const { return _friendlyBranchNames.value(branch.reference().canonicalName()); }
+        QString branchName(const Branch& branch) const { return _branchNames.value(branch.reference().canonicalName()); }
+
+        // the commit HEAD points at, null when HEAD is missing
+        ObjectId headTargetId() const { return _headTargetId; }
+        ObjectId headCommitId() const { return _headCommitId; }
+        ObjectId mostRecentCommitId() const { return _mostRecentCommitId; }
+        ObjectId::List referenceIds() const { return _referenceIds; }
+
+    private:
+        Branch::Map _localBranches;
+        Branch::Map _remoteBranches;
+        Reference::List _references;
+        Stash::List _stashes;
+        QHash<QString, QString> _friendlyBranchNames;
+        QHash<QString, QString> _branchNames;
+        ObjectId _headTargetId;
+        ObjectId _headCommitId;
+        ObjectId _mostRecentCommitId;
+        ObjectId::List _referenceIds;
+    };
+
+    GraphBuilder(Repository* repo, const Snapshot& snapshot);
+
     void reset();
+    void buildBranchTipIndex();
+    bool calculateCachedGraph();
+    bool recalculateGraph();
+    void calculateLayout();
+    Commit::List walkAllCommits();
+    ObjectId::List walkTips() const;
+    Commit::List removeStashes(const Commit::List& commits) const;
+    void collapseMerges();
+    int countMergedCommits(const ObjectId::List& mergeParentIds) const;
+    void publishPreview(const Commit::List& commits);
+    void beginStage(GraphBuildStage stage);
+    ObjectId peelToCommit(const ObjectId& objectId) const;
     void resolveGraphLevels();
     void resolveParentLevels(GraphBuilderCommit* commit);
     int setCommitLevel(GraphBuilderCommit* parent, GraphBuilderCommit* child);
     void buildBranchFromCommitIndex();
     void resolveMergeBirths();
+    void buildGraphLayout();
     void buildGraphLines();
-    GraphItemType drawMergeLine(GraphBuilderCommit* commit, GraphBuilderCommit* toCommit, int lineLevel);
-    void drawHorizontal(GraphBuilderCommit* commit, int fromLevel, int toLevel);
+    GraphedCommit::List toGraphedCommitList();
     bool isMergeComplete(GraphBuilderCommit* mergeCommit, int atIndex) const;
 
+    GraphBuilderCommit::Arena _arena;
     GraphBuilderCommit::PtrList _allCommits;
     GraphBuilderCommit::Map _commitIndex;
     GraphLevelMap _levelMap;
@@ -46,10 +134,34 @@ private:
     QMap<ObjectId, GraphBuilderCommit*> _mergeBirths;
     QMap<ObjectId, GraphBuilderCommit::PtrList> _mergeParents;
 
-    Branch::Map _localBranches;
-    Branch::Map _remoteBranches;
+    Snapshot _snapshot;
+
+    // Branches by the commit they point at, remote branches first, each group in name order
+    QHash<ObjectId, Branch::List> _branchTips;
 
     GraphedCommit::List _graphedCommits;
+    GraphLayout _graphLayout;
+    bool _lazyGraphLines = false;
+    QString _layoutCachePath;
+    QStringList _paths;
+    bool _collapsed = false;
+
+    GraphBuildStatistics _statistics;
+    GraphBuildStage _stage = GraphStageWalk;
+    QElapsedTimer _stageTimer;
+
+    QPromise<GraphedCommit::List>* _promise = nullptr;
+    int _previewCount = 0;
+
+    // The repository the rows belong to, and the handle the calculation uses when it runs on another thread
+    Repository* _owner = nullptr;
+    Repository* _privateRepository = nullptr;
+
+    static const int WalkBatchSize = 1024;
+
+public:
+    // Rows between checks for cancellation in long loops
+    static const int CancelCheckInterval = 4096;
 };
 
 } // namespace GIT
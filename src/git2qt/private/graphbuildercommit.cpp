@@ -1,11 +1,14 @@
 #include "graphbuildercommit.h"
 
 #include "graphbuilder.h"
+#include "mergebaseengine.h"
 
 #include <gitexception.h>
 #include <repository.h>
 #include <stash.h>
 
+#include <algorithm>
+
 using namespace GIT;
 
 GraphBuilderCommit::GraphBuilderCommit() :
@@ -18,48 +21,80 @@ GraphBuilderCommit::GraphBuilderCommit(const Commit& other) :
 {
 }
 
+GraphBuilderCommit::GraphBuilderCommit(const GraphedCommit& other) :
+    GraphedCommit(other)
+{
+}
+
 GraphBuilderCommit::~GraphBuilderCommit()
 {
 }
 
+/**
+ * Clear everything which depends on the rest of the graph (branch names, levels,
+ * lines and children) while keeping what depends only on ancestry: merge base,
+ * merge from, merge birth and the merge/stash flags.
+ *
+ * toGraphedCommit() keeps only the parents which were in the graph, which drops
+ * the index and untracked parents of a stash. The parents are restored from the
+ * commit itself so that the stash is resolved (and its base marked) again.
+ */
+void GraphBuilderCommit::resetLayout()
+{
+    setParentObjectIds(parentIds());
+    setLevel(0);
+    setMaxLevel(0);
+    setHead(false);
+    setRemote(false);
+    setBranchName(QString());
+    setFriendlyBranchName(QString());
+    setMergedInto(ObjectId());
+    setStashBaseOf(ObjectId());
+    setBranchBases(QStringList());
+    setChildObjectIds(ObjectId::List());
+    setGraphLine(GraphLine());
+}
+
 void GraphBuilderCommit::copyBranchInformation(const GraphBuilderCommit* from)
 {
     setBranchName(from->branchName());
     setFriendlyBranchName(from->friendlyBranchName());
 }
 
+void GraphBuilderCommit::setOwner(Repository* repo)
+{
+    setRepository(repo);
+}
+
 GraphedCommit GraphBuilderCommit::toGraphedCommit() const
 {
     GraphedCommit commit(*this);
-    commit.setChildObjectIds(_childCommits.objectIds());
-    commit.setParentObjectIds(_parentCommits.objectIds());
+    commit.setChildObjectIds(childCommits().objectIds());
+    commit.setParentObjectIds(parentCommits().objectIds());
     return commit;
 }
 
 // -------------------------------- GraphBuilderCommit::PtrList --------------------------------
 
-void GraphBuilderCommit::PtrList::detectStashes(Repository* repo)
+void GraphBuilderCommit::PtrList::detectStashes(const Stash::List& stashes)
 {
     Map map(*this);
-    Stash::List stashes = repo->stashes();
-    PtrList deleteList;
+    Set removed;
     for(const Stash& stash : stashes) {
         GraphBuilderCommit* commit;
-        if((commit = map.value(stash.index().objectId())) != nullptr && deleteList.contains(commit) == false) {
-            deleteList.append(commit);
+        if((commit = map.value(stash.indexId())) != nullptr) {
+            removed.insert(commit);
         }
-        if((commit = map.value(stash.untracked().objectId())) != nullptr && deleteList.contains(commit) == false) {
-            deleteList.append(commit);
-        }
-        if((commit = map.value(stash.untracked().objectId())) != nullptr) {
+        if((commit = map.value(stash.untrackedId())) != nullptr) {
+            removed.insert(commit);
             commit->setStash(true);
         }
     }
 
-    for(GraphBuilderCommit* commit : deleteList) {
-        removeAll(commit);
+    // removed commits stay in the arena until the graph is released
+    if(removed.isEmpty() == false) {
+        erase(std::remove_if(begin(), end(), [&removed](GraphBuilderCommit* commit) { return removed.contains(commit); }), end());
     }
-    qDeleteAll(deleteList);
 
     // rebuild indexes
     for(int index = 0;index < count();index++) {
@@ -68,34 +103,63 @@ void GraphBuilderCommit::PtrList::detectStashes(Repository* repo)
     }
 }
 
-void GraphBuilderCommit::PtrList::resolveParentsAndChildren()
+void GraphBuilderCommit::PtrList::resolveParentsAndChildren(Arena& arena)
 {
     Map map(*this);
 
+    // resolve and count the edges first so they can be laid out in one array
+    PtrList parents;
+    parents.reserve(count() + (count() / 4));
+    for(GraphBuilderCommit* commit : *this) {
+        commit->_parentCount = 0;
+        commit->_childCount = 0;
+    }
     for(GraphBuilderCommit* commit : *this) {
         for(const ObjectId& parentId : commit->parentObjectIds()) {
             GraphBuilderCommit* parent = map.value(parentId);
             if(parent != nullptr) {
-                parent->childCommitsRef().append(commit);
-                commit->parentCommitsRef().append(parent);
+                parents.append(parent);
+                commit->_parentCount++;
+                parent->_childCount++;
             }
             else {
                 Log::logText(LVL_WARNING, "Failed to find child in map");
             }
         }
     }
+
+    // every edge appears once as a parent and once as a child
+    GraphBuilderCommit** edges = arena.allocateEdges(parents.count() * 2);
+    for(GraphBuilderCommit* commit : *this) {
+        commit->_edges = edges;
+        edges += commit->_parentCount + commit->_childCount;
+        commit->_childCount = 0;
+    }
+
+    // children are filled in commit order
+    int next = 0;
+    for(GraphBuilderCommit* commit : *this) {
+        for(int i = 0;i < commit->_parentCount;i++) {
+            GraphBuilderCommit* parent = parents.at(next++);
+            commit->_edges[i] = parent;
+            parent->_edges[parent->_parentCount + parent->_childCount++] = commit;
+        }
+    }
 }
 
-void GraphBuilderCommit::PtrList::resolveMergesAndStashes(Repository* repo)
+void GraphBuilderCommit::PtrList::resolveMergesAndStashes(const GraphBuilder* graphBuilder, const Stash::List& stashes)
 {
     Map map(*this);
-
-    Stash::List stashes = repo->stashes();
+    MergeBaseEngine mergeBaseEngine(*this);
+    Repository* repo = graphBuilder->repository();
 
     try
     {
         for(GraphBuilderCommit* commit : *this) {
-            if(commit->parents().count() > 1) {
+            if(commit->parentObjectIds().count() > 1) {
+                // finding a merge base may walk a long way
+                graphBuilder->checkCanceled();
+
                 /**
                  * This is a merge or a stash
                  */
@@ -104,7 +168,7 @@ void GraphBuilderCommit::PtrList::resolveMergesAndStashes(Repository* repo)
                     commit->setStash(true);
 
                     // Set the stash-base-of
-                    GraphBuilderCommit* stashBaseCommit = map.value(stash.base().objectId());
+                    GraphBuilderCommit* stashBaseCommit = map.value(stash.baseId());
                     if(stashBaseCommit == nullptr) {
                         throw GitException("Failed to find stash base");
                     }
@@ -113,25 +177,39 @@ void GraphBuilderCommit::PtrList::resolveMergesAndStashes(Repository* repo)
                 else {
                     commit->setMerge(true);
 
-                    // Find the merge-base and the merge-from
-                    ObjectId::List parentIds = commit->parentObjectIds();
-                    parentIds.append(commit->objectId());
+                    // Find the merge-base and the merge-from (already known when carried over from a previous graph)
+                    if(commit->mergeBase().isValid() == false) {
+                        ObjectId::List parentIds = commit->parentObjectIds();
 
-                    Commit mergeBase = repo->objectDatabase()->findMergeBase(parentIds);
-                    if(mergeBase.isValid() == false) {
-                        throw GitException("Failed to find merge base commit");
-                    }
+                        // Answer from the in-memory graph unless a parent is missing from it
+                        ObjectId mergeBaseId;
+                        if(commit->parentCommits().count() == parentIds.count()) {
+                            GraphBuilderCommit::PtrList inputs = commit->parentCommits().toPtrList();
+                            inputs.append(commit);
+                            GraphBuilderCommit* mergeBase = mergeBaseEngine.findMergeBase(inputs);
+                            if(mergeBase != nullptr) {
+                                mergeBaseId = mergeBase->objectId();
+                            }
+                        }
+                        else {
+                            ObjectId::List inputIds = parentIds;
+                            inputIds.append(commit->objectId());
+                            mergeBaseId = repo->objectDatabase()->findMergeBase(inputIds).objectId();
+                        }
 
-                    parentIds.removeAll(commit->objectId());
+                        if(mergeBaseId.isValid() == false) {
+                            throw GitException("Failed to find merge base commit");
+                        }
 
-                    commit->setMergeBase(mergeBase.objectId());
-                    parentIds.removeAll(mergeBase.objectId());
+                        commit->setMergeBase(mergeBaseId);
+                        parentIds.removeAll(mergeBaseId);
 
-                    if(parentIds.count() != 1) {
-                        throw GitException("Too many merge parents left (bug)");
-                    }
+                        if(parentIds.count() != 1) {
+                            throw GitException("Too many merge parents left (bug)");
+                        }
 
-                    commit->setMergeFrom(parentIds.at(0));
+                        commit->setMergeFrom(parentIds.at(0));
+                    }
 
                     // Set the merge-base-of
                     GraphBuilderCommit* mergeBaseCommit = map.value(commit->mergeBase());
@@ -151,6 +229,9 @@ void GraphBuilderCommit::PtrList::resolveMergesAndStashes(Repository* repo)
     }
     catch(const GitException& e)
     {
+        if(graphBuilder->isCanceled()) {
+            throw;
+        }
         Log::logText(LVL_WARNING, e.message());
     }
 }
@@ -158,17 +239,22 @@ void GraphBuilderCommit::PtrList::resolveMergesAndStashes(Repository* repo)
 void GraphBuilderCommit::PtrList::resolveBranchNames(GraphBuilder* graphBuilder)
 {
     QString lastBranchName;
-    for(GraphBuilderCommit* commit : *this) {
+    for(int index = 0;index < count();index++) {
+        GraphBuilderCommit* commit = at(index);
+        if((index % GraphBuilder::CancelCheckInterval) == 0) {
+            graphBuilder->checkCanceled();
+        }
+
         // Resolve branch for this commit
         Branch commitBranch = graphBuilder->findBranchForReferencedObjectId(commit->objectId());
         if(commitBranch.isValid()) {
             commit->setHead(true);
-            commit->setFriendlyBranchName(commitBranch.friendlyName(true));
-            commit->setBranchName(commitBranch.friendlyName(false));
+            commit->setFriendlyBranchName(graphBuilder->friendlyBranchName(commitBranch));
+            commit->setBranchName(graphBuilder->branchName(commitBranch));
             commit->setRemote(commitBranch.isRemote());
         }
-        else if(commit->childCommitsRef().count() > 0 || commit->isMerge()) {
-            for(GraphBuilderCommit* child : commit->childCommitsRef()) {
+        else if(commit->childCommits().count() > 0 || commit->isMerge()) {
+            for(GraphBuilderCommit* child : commit->childCommits()) {
                 if(child->friendlyBranchName().isEmpty() == false) {
                     commit->copyBranchInformation(child);
                     break;
@@ -196,4 +282,33 @@ void GraphBuilderCommit::PtrList::resolveBranchNames(GraphBuilder* graphBuilder)
     }
 }
 
+// -------------------------------- GraphBuilderCommit::Arena --------------------------------
 
+GraphBuilderCommit::PtrList GraphBuilderCommit::Arena::create(const Commit::List& commits)
+{
+    PtrList result;
+    result.reserve(commits.count());
+    for(const Commit& commit : commits) {
+        result.append(create(commit));
+    }
+    return result;
+}
+
+GraphBuilderCommit** GraphBuilderCommit::Arena::allocateEdges(int count)
+{
+    _edges.fill(nullptr, count);
+    return _edges.data();
+}
+
+void GraphBuilderCommit::Arena::clear()
+{
+    for(int index = 0;index < _count;index++) {
+        (_blocks.at(index / BlockSize) + (index % BlockSize))->~GraphBuilderCommit();
+    }
+    for(GraphBuilderCommit* block : _blocks) {
+        ::operator delete(block);
+    }
+    _blocks.clear();
+    _count = 0;
+    _edges = QVector<GraphBuilderCommit*>();
+}
@@ -1,6 +1,11 @@
 #ifndef GRAPHBUILDERCOMMIT_H
 #define GRAPHBUILDERCOMMIT_H
 #include <git2qt/graphedcommit.h>
+#include <git2qt/stash.h>
+
+#include <QVector>
+
+#include <new>
 
 namespace GIT {
 
@@ -11,32 +16,62 @@ class GraphBuilderCommit : public GraphedCommit
 public:
     GraphBuilderCommit();
     GraphBuilderCommit(const Commit& other);
+    GraphBuilderCommit(const GraphedCommit& other);
     virtual ~GraphBuilderCommit();
 
     void copyBranchInformation(const GraphBuilderCommit* from);
+    void resetLayout();
+
+    // The repository the finished row belongs to, see GraphBuilder::openPrivateRepository()
+    void setOwner(Repository* repo);
 
     GraphedCommit toGraphedCommit() const;
 
+    class Arena;
+
     class PtrList : public QList<GraphBuilderCommit*>
     {
     public:
         PtrList() {}
-        PtrList(const Commit::List& other) {
-            for(const Commit& commit : other) {
-                append(new GraphBuilderCommit(commit));
+
+        void detectStashes(const Stash::List& stashes);
+        void resolveParentsAndChildren(Arena& arena);
+        void resolveMergesAndStashes(const GraphBuilder* graphBuilder, const Stash::List& stashes);
+        void resolveBranchNames(GraphBuilder* graphBuilder);
+
+        ObjectId::List objectIds() const
+        {
+            ObjectId::List result;
+            for(GraphBuilderCommit* commit : *this) {
+                result.append(commit->objectId());
             }
+            return result;
         }
+    };
 
-        void detectStashes(Repository* repo);
-        void resolveParentsAndChildren();
-        void resolveMergesAndStashes(Repository* repo);
-        void resolveBranchNames(GraphBuilder* graphBuilder);
+    /**
+     * A non-owning view of a commit's parents or children inside the
+     * arena's edge array
+     */
+    class EdgeList
+    {
+    public:
+        EdgeList(GraphBuilderCommit* const* edges, int count) :
+            _edges(edges), _count(count) {}
 
-        GraphedCommit::List toGraphedCommitList() const
+        int count() const { return _count; }
+        bool isEmpty() const { return _count == 0; }
+        GraphBuilderCommit* at(int index) const { return _edges[index]; }
+
+        GraphBuilderCommit* const* begin() const { return _edges; }
+        GraphBuilderCommit* const* end() const { return _edges + _count; }
+
+        PtrList toPtrList() const
         {
-            GraphedCommit::List result;
+            PtrList result;
+            result.reserve(_count);
             for(GraphBuilderCommit* commit : *this) {
-                result.append(commit->toGraphedCommit());
+                result.append(commit);
             }
             return result;
         }
@@ -44,11 +79,61 @@ public:
         ObjectId::List objectIds() const
         {
             ObjectId::List result;
+            result.reserve(_count);
             for(GraphBuilderCommit* commit : *this) {
                 result.append(commit->objectId());
             }
             return result;
         }
+
+    private:
+        GraphBuilderCommit* const* _edges;
+        int _count;
+    };
+
+    /**
+     * Owns every GraphBuilderCommit of one graph calculation.
+     *
+     * Commits are constructed in place in fixed size blocks and the parent
+     * and child edges of all of them share a single array (CSR layout), so a
+     * graph of N commits costs N / BlockSize allocations for its nodes and one
+     * for its edges, and clear() releases all of it at once.
+     */
+    class Arena
+    {
+    public:
+        Arena() {}
+        ~Arena() { clear(); }
+
+        GraphBuilderCommit* create(const Commit& commit) { return construct(commit); }
+        GraphBuilderCommit* create(const GraphedCommit& commit) { return construct(commit); }
+        PtrList create(const Commit::List& commits);
+
+        // Replaces the edge array of the previous graph
+        GraphBuilderCommit** allocateEdges(int count);
+
+        int count() const { return _count; }
+        void clear();
+
+    private:
+        Q_DISABLE_COPY(Arena)
+
+        template <typename T>
+        GraphBuilderCommit* construct(const T& from)
+        {
+            if(_count == _blocks.count() * BlockSize) {
+                _blocks.append(static_cast<GraphBuilderCommit*>(::operator new(sizeof(GraphBuilderCommit) * BlockSize)));
+            }
+            GraphBuilderCommit* commit = new (_blocks.at(_count / BlockSize) + (_count % BlockSize)) GraphBuilderCommit(from);
+            _count++;
+            return commit;
+        }
+
+        QList<GraphBuilderCommit*> _blocks;
+        int _count = 0;
+        QVector<GraphBuilderCommit*> _edges;
+
+        static const int BlockSize = 1024;
     };
 
     class Set : public QSet<GraphBuilderCommit*>
@@ -67,12 +152,14 @@ public:
         }
     };
 
-    PtrList& parentCommitsRef() { return _parentCommits; }
-    PtrList& childCommitsRef() { return _childCommits; }
+    EdgeList parentCommits() const { return EdgeList(_edges, _parentCount); }
+    EdgeList childCommits() const { return EdgeList(_edges + _parentCount, _childCount); }
 
 private:
-    PtrList _parentCommits;
-    PtrList _childCommits;
+    // parents followed by children, in the arena's edge array
+    GraphBuilderCommit** _edges = nullptr;
+    int _parentCount = 0;
+    int _childCount = 0;
 };
 
 } // namespace GIT
@@ -0,0 +1,357 @@
+#include "graphlayoutcache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
+#include <log.h>
+#include <git2qt/private/commitgraphfile.h>
+#include <repository.h>
+#include <stash.h>
+#include <utility.h>
+
+using namespace GIT;
+
+namespace {
+
+// merge metadata which is only written when valid, in this order
+const int OptionalIdCount = 5;
+
+void writeObjectId(QDataStream& stream, const ObjectId& objectId)
+{
+    stream.writeRawData(reinterpret_cast<const char*>(objectId.rawData()), GitOid::Size);
+}
+
+bool readObjectId(QDataStream& stream, ObjectId& objectId)
+{
+    char raw[GitOid::Size];
+    if(stream.readRawData(raw, GitOid::Size) != GitOid::Size) {
+        return false;
+    }
+    objectId = ObjectId(GitOid(reinterpret_cast<const uchar*>(raw), GitOid::Size));
+    return true;
+}
+
+} // namespace
+
+bool GraphLayoutCache::read(Repository* repo, GraphedCommit::List& commits, Repository* owner)
+{
+    commits.clear();
+    _key.clear();
+
+    QFile file(_path);
+    if(file.exists() == false || file.open(QIODevice::ReadOnly) == false) {
+        return false;
+    }
+
+    qint64 size = file.size();
+    const uchar* data = size >= HeaderSize ? file.map(0, size) : nullptr;
+    if(data == nullptr) {
+        return false;
+    }
+
+    bool result = false;
+    if(qFromBigEndian<quint32>(data) == FileSignature &&
+       qFromBigEndian<quint32>(data + 4) == FileVersion &&
+       HeaderSize + (qint64)qFromBigEndian<quint32>(data + 12) == size) {
+        int count = qFromBigEndian<quint32>(data + 8);
+
+        // rows are decoded straight from the mapping
+        QByteArray body = QByteArray::fromRawData(reinterpret_cast<const char*>(data) + HeaderSize, size - HeaderSize);
+        git_odb* odb = nullptr;
+        if(git_repository_odb(&odb, repo->handle().value()) == 0) {
+            result = readRows(repo, owner != nullptr ? owner : repo, odb, body, count, commits);
+            git_odb_free(odb);
+        }
+        if(result) {
+            _key = QByteArray(reinterpret_cast<const char*>(data) + 16, KeySize);
+        }
+    }
+
+    file.unmap(const_cast<uchar*>(data));
+    file.close();
+
+    if(result == false) {
+        Log::logText(LVL_DEBUG, QString("Ignoring unusable graph layout cache at %1").arg(_path));
+        commits.clear();
+    }
+    return result;
+}
+
+bool GraphLayoutCache::readRows(Repository* repo, Repository* owner, git_odb* odb, const QByteArray& body, int count, GraphedCommit::List& commits) const
+{
+    QDataStream stream(body);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    QStringList strings;
+    stream >> strings;
+
+    QVector<QList<qint32>> parentRows(count);
+    QVector<QList<qint32>> childRows(count);
+    commits.reserve(count);
+
+    for(int row = 0;row < count;row++) {
+        ObjectId objectId, treeId;
+        if(readObjectId(stream, objectId) == false || readObjectId(stream, treeId) == false) {
+            return false;
+        }
+
+        qint64 commitTime;
+        quint16 parentCount;
+        stream >> commitTime >> parentCount;
+        ObjectId::List parentIds;
+        for(int i = 0;i < parentCount;i++) {
+            ObjectId parentId;
+            if(readObjectId(stream, parentId) == false) {
+                return false;
+            }
+            parentIds.append(parentId);
+        }
+
+        // a commit which is gone means history was rewritten and pruned
+        if(stream.status() != QDataStream::Ok || commitExists(repo, odb, objectId) == false) {
+            return false;
+        }
+
+        GraphedCommit commit = Commit::fromHeader(owner, objectId, CommitCache::Entry(treeId, parentIds, commitTime));
+        commit.setIndex(row);
+
+        qint32 level, maxLevel, branchName, friendlyBranchName;
+        quint8 flags, present;
+        stream >> level >> maxLevel >> flags >> branchName >> friendlyBranchName >> present;
+        if(branchName < 0 || branchName >= strings.count() || friendlyBranchName < 0 || friendlyBranchName >= strings.count()) {
+            return false;
+        }
+        commit.setLevel(level);
+        commit.setMaxLevel(maxLevel);
+        commit.setHead(flags & RowHead);
+        commit.setMerge(flags & RowMerge);
+        commit.setStash(flags & RowStash);
+        commit.setStashParent(flags & RowStashParent);
+        commit.setRemote(flags & RowRemote);
+        commit.setBranchName(strings.at(branchName));
+        commit.setFriendlyBranchName(strings.at(friendlyBranchName));
+
+        ObjectId ids[OptionalIdCount];
+        for(int i = 0;i < OptionalIdCount;i++) {
+            if((present & (1 << i)) && readObjectId(stream, ids[i]) == false) {
+                return false;
+            }
+        }
+        commit.setMergeBase(ids[0]);
+        commit.setMergeFrom(ids[1]);
+        commit.setMergedInto(ids[2]);
+        commit.setMergeBirth(ids[3]);
+        commit.setStashBaseOf(ids[4]);
+
+        QList<qint32> branchBases;
+        stream >> branchBases;
+        QStringList bases;
+        for(qint32 index : branchBases) {
+            if(index < 0 || index >= strings.count()) {
+                return false;
+            }
+            bases.append(strings.at(index));
+        }
+        commit.setBranchBases(bases);
+
+        stream >> parentRows[row] >> childRows[row];
+
+        quint16 levelCount;
+        stream >> levelCount;
+        GraphLine graphLine;
+        for(int i = 0;i < levelCount;i++) {
+            quint16 items;
+            stream >> items;
+            graphLine.setGraphItem(i, GraphItemTypes::fromInt(items));
+        }
+        commit.setGraphLine(graphLine);
+
+        if(stream.status() != QDataStream::Ok) {
+            return false;
+        }
+        commits.append(commit);
+    }
+
+    // parents and children are stored as rows
+    for(int row = 0;row < count;row++) {
+        ObjectId::List parentIds;
+        for(qint32 parentRow : parentRows.at(row)) {
+            if(parentRow < 0 || parentRow >= count) {
+                return false;
+            }
+            parentIds.append(commits.at(parentRow).objectId());
+        }
+        ObjectId::List childIds;
+        for(qint32 childRow : childRows.at(row)) {
+            if(childRow < 0 || childRow >= count) {
+                return false;
+            }
+            childIds.append(commits.at(childRow).objectId());
+        }
+        commits[row].setParentObjectIds(parentIds);
+        commits[row].setChildObjectIds(childIds);
+    }
+    return stream.atEnd();
+}
+
+/**
+ * Answered from the commit-graph file when it knows the commit, otherwise
+ * from the object database, which checks for the object without reading it.
+ */
+bool GraphLayoutCache::commitExists(Repository* repo, git_odb* odb, const ObjectId& objectId)
+{
+    const CommitGraphFile* graphFile = repo->commitGraphFile();
+    if(graphFile != nullptr && graphFile->positionOf(objectId) >= 0) {
+        return true;
+    }
+    return git_odb_exists(odb, objectId.toNative()) != 0;
+}
+
+bool GraphLayoutCache::write(const GraphedCommit::List& commits, const QByteArray& key)
+{
+    if(key.size() != KeySize) {
+        return false;
+    }
+
+    QHash<ObjectId, int> rows;
+    rows.reserve(commits.count());
+    QStringList strings;
+    QHash<QString, int> stringIndex;
+    auto intern = [&strings, &stringIndex](const QString& value)
+    {
+        auto it = stringIndex.constFind(value);
+        if(it == stringIndex.constEnd()) {
+            it = stringIndex.insert(value, strings.count());
+            strings.append(value);
+        }
+        return (qint32)it.value();
+    };
+    for(int row = 0;row < commits.count();row++) {
+        const GraphedCommit& commit = commits.at(row);
+        rows.insert(commit.objectId(), row);
+        intern(commit.branchName());
+        intern(commit.friendlyBranchName());
+        for(const QString& base : commit.branchBases()) {
+            intern(base);
+        }
+    }
+
+    QByteArray body;
+    QDataStream stream(&body, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << strings;
+
+    for(const GraphedCommit& commit : commits) {
+        writeObjectId(stream, commit.objectId());
+        writeObjectId(stream, commit.treeId());
+        ObjectId::List parentIds = commit.parentIds();
+        stream << (qint64)commit.timestamp().toSecsSinceEpoch() << (quint16)parentIds.count();
+        for(const ObjectId& parentId : parentIds) {
+            writeObjectId(stream, parentId);
+        }
+
+        quint8 flags = 0;
+        flags |= commit.isHead() ? RowHead : 0;
+        flags |= commit.isMerge() ? RowMerge : 0;
+        flags |= commit.isStash() ? RowStash : 0;
+        flags |= commit.isStashParent() ? RowStashParent : 0;
+        flags |= commit.isRemote() ? RowRemote : 0;
+
+        ObjectId ids[OptionalIdCount] = { commit.mergeBase(), commit.mergeFrom(), commit.mergedInto(), commit.mergeBirth(), commit.stashBaseOf() };
+        quint8 present = 0;
+        for(int i = 0;i < OptionalIdCount;i++) {
+            present |= ids[i].isValid() ? (1 << i) : 0;
+        }
+
+        stream << (qint32)commit.level() << (qint32)commit.maxLevel() << flags
+               << intern(commit.branchName()) << intern(commit.friendlyBranchName()) << present;
+        for(int i = 0;i < OptionalIdCount;i++) {
+            if(ids[i].isValid()) {
+                writeObjectId(stream, ids[i]);
+            }
+        }
+
+        QList<qint32> branchBases;
+        for(const QString& base : commit.branchBases()) {
+            branchBases.append(intern(base));
+        }
+        stream << branchBases;
+
+        // only links within the graph are kept
+        QList<qint32> parentRows;
+        for(const ObjectId& parentId : commit.parentObjectIds()) {
+            if(rows.contains(parentId)) {
+                parentRows.append(rows.value(parentId));
+            }
+        }
+        QList<qint32> childRows;
+        for(const ObjectId& childId : commit.childObjectIds()) {
+            if(rows.contains(childId)) {
+                childRows.append(rows.value(childId));
+            }
+        }
+        stream << parentRows << childRows;
+
+        GraphLine graphLine = commit.graphLine();
+        stream << (quint16)graphLine.levelCount();
+        for(int level = 0;level < graphLine.levelCount();level++) {
+            stream << (quint16)graphLine.graphItem(level).toInt();
+        }
+    }
+
+    uchar header[HeaderSize];
+    qToBigEndian<quint32>(FileSignature, header);
+    qToBigEndian<quint32>(FileVersion, header + 4);
+    qToBigEndian<quint32>(commits.count(), header + 8);
+    qToBigEndian<quint32>(body.size(), header + 12);
+    memcpy(header + 16, key.constData(), KeySize);
+
+    // readers never see a partly written file
+    QSaveFile file(_path);
+    bool result = file.open(QIODevice::WriteOnly) &&
+                  file.write(reinterpret_cast<const char*>(header), HeaderSize) == HeaderSize &&
+                  file.write(body) == body.size() &&
+                  file.commit();
+    if(result == false) {
+        Log::logText(LVL_WARNING, QString("Failed to write graph layout cache %1").arg(_path));
+    }
+    return result;
+}
+
+/**
+ * A hash of every reference with its target, and of the stash list.
+ * References are read from what the repository already has loaded, so
+ * computing the key touches no objects.
+ */
+QByteArray GraphLayoutCache::currentKey(Repository* repo)
+{
+    return currentKey(repo->references(), repo->stashes());
+}
+
+QByteArray GraphLayoutCache::currentKey(const Reference::List& references, const Stash::List& stashes)
+{
+    QStringList tips;
+    for(const Reference& reference : references) {
+        tips.append(QString("%1 %2 %3").arg(reference.canonicalName(), reference.targetIdentifier(), reference.targetObjectId().toString()));
+    }
+    tips.sort();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for(const QString& tip : tips) {
+        hash.addData(tip.toUtf8());
+        hash.addData("\n");
+    }
+    hash.addData("stashes\n");
+    for(const Stash& stash : stashes) {
+        hash.addData(stash.workTree().objectId().toString().toUtf8());
+        hash.addData("\n");
+    }
+    return hash.result();
+}
+
+QString GraphLayoutCache::defaultPath(Repository* repo)
+{
+    return Utility::combine(git_repository_path(repo->handle().value()), "git2qt-graph-layout");
+}
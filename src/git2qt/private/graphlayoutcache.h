@@ -0,0 +1,75 @@
+#ifndef GRAPHLAYOUTCACHE_H
+#define GRAPHLAYOUTCACHE_H
+#include <git2qt/graphedcommit.h>
+#include <git2qt/gitoid.h>
+#include <git2qt/reference.h>
+#include <git2qt/stash.h>
+
+#include <QByteArray>
+
+namespace GIT {
+
+class Repository;
+
+/**
+ * Versioned binary copy of a calculated commit graph, kept in the
+ * repository's git directory so that a graph survives between sessions.
+ *
+ * The file holds the rows of a graph (commit headers, lanes, merge metadata,
+ * branch names and line glyphs) along with a key which is a hash of every
+ * reference, its target and the stash list at the time the graph was written. A
+ * matching key means the graph can be used as it is. Otherwise the rows
+ * are still a valid previous graph for GraphBuilder::calculateGraph(previous),
+ * which extends them with new commits or recalculates from scratch when
+ * history was rewritten.
+ *
+ * The file is memory-mapped for reading and written atomically. Commits
+ * are built from the stored tree id, parent ids and commit time, so a read
+ * costs one existence check per commit rather than a commit lookup. A file
+ * which is truncated, from another version, or which names a commit no
+ * longer in the object database is ignored.
+ */
+class GraphLayoutCache
+{
+public:
+    GraphLayoutCache(const QString& path) :
+        _path(path) {}
+
+    // Rows are checked against repo and belong to owner (repo when null)
+    bool read(Repository* repo, GraphedCommit::List& commits, Repository* owner = nullptr);
+    bool write(const GraphedCommit::List& commits, const QByteArray& key);
+
+    // The key of the graph found by the last successful read()
+    QByteArray key() const { return _key; }
+    QString path() const { return _path; }
+
+    static QByteArray currentKey(Repository* repo);
+    static QByteArray currentKey(const Reference::List& references, const Stash::List& stashes);
+    static QString defaultPath(Repository* repo);
+
+private:
+    bool readRows(Repository* repo, Repository* owner, git_odb* odb, const QByteArray& body, int count, GraphedCommit::List& commits) const;
+    static bool commitExists(Repository* repo, git_odb* odb, const ObjectId& objectId);
+
+    enum RowFlag
+    {
+        RowHead         = 0x01,
+        RowMerge        = 0x02,
+        RowStash        = 0x04,
+        RowStashParent  = 0x08,
+        RowRemote       = 0x10,
+    };
+
+    QString _path;
+    QByteArray _key;
+
+    static const int KeySize = 20;
+    static const int HeaderSize = 16 + KeySize;
+
+    static const quint32 FileSignature = 0x474c4159;   // "GLAY"
+    static const quint32 FileVersion = 2;
+};
+
+} // namespace GIT
+
+#endif // GRAPHLAYOUTCACHE_H
@@ -1,56 +1,105 @@
 #include "graphlevelmap.h"
-#include "log.h"
+
+#include <QtAlgorithms>
 
 using namespace GIT;
 
-const QString GraphLevelMap::MergeSourceTag     = "src-";
+GraphLevelMap::GraphLevelMap()
+{
+    // level 0 is never available
+    _inUse.append(1);
+    _levelOwners.resize(64);
+}
 
-ObjectId::List GraphLevelMap::mergeIds() const
+GraphLevelMap::Owner GraphLevelMap::branchOwner(const QString& branchName)
 {
-    ObjectId::List result;
-    QStringList keys = GraphLevelMap::keys();
-    for(const QString& key : keys) {
-        if(key.startsWith(MergeSourceTag) && key.length() > MergeSourceTag.length() + 1) {
-            ObjectId oid(key.mid(MergeSourceTag.length()));
-            if(oid.isValid()) {
-                result.append(oid);
-            }
-        }
-        else {
-            ObjectId oid(key);
-            if(oid.isValid()) {
-                result.append(oid);
-            }
-        }
+    auto it = _branchNames.constFind(branchName);
+    if(it == _branchNames.constEnd()) {
+        it = _branchNames.insert(branchName, _branchNames.count());
     }
-    return result;
+    return makeOwner(BranchOwner, it.value());
 }
 
-void GraphLevelMap::addLevel(const QString &name, int level)
+void GraphLevelMap::addLevel(Owner owner, int level)
 {
-    insert(name, level);
+    removeOwner(owner);
+    if(level >= _levelOwners.count()) {
+        _levelOwners.resize(qMax(level + 1, _levelOwners.count() * 2));
+    }
+    _owners.insert(owner, level);
+    _levelOwners[level].append(owner);
+    setInUse(level, true);
 }
 
-void GraphLevelMap::removeLevel(const QString &level)
+void GraphLevelMap::removeOwner(Owner owner)
 {
-    remove(level);
+    auto it = _owners.find(owner);
+    if(it == _owners.end()) {
+        return;
+    }
+
+    int level = it.value();
+    _owners.erase(it);
+
+    QList<Owner>& owners = _levelOwners[level];
+    owners.removeOne(owner);
+    if(owners.isEmpty()) {
+        setInUse(level, false);
+    }
 }
 
 void GraphLevelMap::removeLevel(int level)
 {
-    QStringList foundKeys;
-    auto it = begin();
-    for(;it != end();it++) {
-        if(it.value() == level) {
-            foundKeys.append(it.key());
+    if(level <= 0 || level >= _levelOwners.count()) {
+        return;
+    }
+
+    for(Owner owner : _levelOwners.at(level)) {
+        _owners.remove(owner);
+    }
+    _levelOwners[level].clear();
+    setInUse(level, false);
+}
+
+bool GraphLevelMap::containsLevel(int level) const
+{
+    int word = level / 64;
+    return level > 0 && word < _inUse.count() && (_inUse.at(word) & (1ULL << (level % 64))) != 0;
+}
+
+int GraphLevelMap::availableLevel() const
+{
+    for(int word = 0;word < _inUse.count();word++) {
+        quint64 free = ~_inUse.at(word);
+        if(free != 0) {
+            return (word * 64) + qCountTrailingZeroBits(free);
         }
     }
-    for(const QString& key : foundKeys) {
-        remove(key);
+    return _inUse.count() * 64;
+}
+
+int GraphLevelMap::maxLevel() const
+{
+    for(int word = _inUse.count() - 1;word >= 0;word--) {
+        // bit 0 of word 0 is the reserved level 0
+        quint64 bits = word == 0 ? _inUse.at(word) & ~1ULL : _inUse.at(word);
+        if(bits != 0) {
+            return (word * 64) + 63 - qCountLeadingZeroBits(bits);
+        }
     }
+    return 0;
 }
 
-QString GraphLevelMap::makeMergeSourceString(const ObjectId &objectId)
+void GraphLevelMap::setInUse(int level, bool value)
 {
-    return QString("%1%2").arg(MergeSourceTag).arg(objectId.toString());
+    int word = level / 64;
+    if(word >= _inUse.count()) {
+        _inUse.resize(word + 1);
+    }
+    if(value) {
+        _inUse[word] |= (1ULL << (level % 64));
+    }
+    else {
+        _inUse[word] &= ~(1ULL << (level % 64));
+    }
 }
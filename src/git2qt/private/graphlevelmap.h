@@ -1,75 +1,60 @@
 #ifndef GRAPHLEVELMAP_H
 #define GRAPHLEVELMAP_H
 #include <git2qt/gittypes.h>
-#include <git2qt/objectid.h>
+
+#include <QHash>
+#include <QVector>
 
 namespace GIT {
 
-class GraphLevelMap : private QMap<QString, int>
+/**
+ * Lane (level) allocator for the graph builder.
+ *
+ * Lanes in use are tracked in a bitset so that the lowest free lane is
+ * found with a find-first-zero over 64-bit words. Lanes are owned by
+ * integer keys: an interned branch name, or the row index of a merge
+ * commit (either the merge itself or the source it was merged from).
+ * A lane stays in use until all of its owners are removed.
+ *
+ * Level 0 means "no level" and is never handed out.
+ */
+class GraphLevelMap
 {
 public:
-    QList<int> levelsInUse() const
+    enum OwnerType
     {
-        return values();
-    }
+        BranchOwner = 0,
+        MergeOwner,
+        MergeSourceOwner,
+    };
 
-    ObjectId::List mergeIds() const;
+    typedef quint64 Owner;
 
-    void addLevel(const QString& name, int level);
+    GraphLevelMap();
 
-    void removeLevel(const QString& level);
+    static Owner makeOwner(OwnerType type, int index) { return ((quint64)type << 32) | (quint32)index; }
+    static Owner mergeOwner(int commitIndex) { return makeOwner(MergeOwner, commitIndex); }
+    static Owner mergeSourceOwner(int commitIndex) { return makeOwner(MergeSourceOwner, commitIndex); }
+    Owner branchOwner(const QString& branchName);
 
+    void addLevel(Owner owner, int level);
+    void removeOwner(Owner owner);
     void removeLevel(int level);
 
-    QString nameForLevel(int level) const
-    {
-        QString name;
-        for(auto it = constBegin();it != constEnd();it++) {
-            if(it.value() == level) {
-                name = it.key();
-                break;
-            }
-        }
-        return name;
-    }
-
-    bool containsName(const QString& name) const
-    {
-        return contains(name);
-    }
-
-    bool containsLevel(int level) const
-    {
-        auto it = std::find_if(constBegin(), constEnd(), [level](int value) { return level == value; });
-        return it != constEnd();
-    }
+    bool containsOwner(Owner owner) const { return _owners.contains(owner); }
+    bool containsLevel(int level) const;
+    int levelForOwner(Owner owner) const { return _owners.value(owner, 0); }
 
-    int levelForName(const QString& name) const
-    {
-        return value(name, 0);
-    }
-
-    int availableLevel(int exclude = 0) const
-    {
-        int result = 1;
-        for(;result == exclude || levelsInUse().contains(result) == true;result++);
-        return result;
-    }
-
-    int maxLevel() const
-    {
-        int level = 0;
-        QList<int> levels = values();
-        auto it = std::max_element(levels.constBegin(), levels.constEnd());
-        if(it != levels.constEnd()) {
-            level = *it;
-        }
-        return level;
-    }
+    int availableLevel() const;
+    int maxLevel() const;
 
-    static QString makeMergeSourceString(const ObjectId& objectId);
+private:
+    void setInUse(int level, bool value);
 
-    static const QString MergeSourceTag;
+    QHash<Owner, int> _owners;
+    QVector<QList<Owner>> _levelOwners;
+    QVector<quint64> _inUse;
+    QHash<QString, int> _branchNames;
 };
 
 } // namespace GIT
@@ -0,0 +1,207 @@
+#include "historysimplifier.h"
+
+#include "commitgraphfile.h"
+
+#include <repository.h>
+
+#include <QVector>
+
+using namespace GIT;
+
+HistorySimplifier::HistorySimplifier(Repository* repo, const QStringList& paths) :
+    _repo(repo)
+{
+    for(const QString& path : paths) {
+        QList<QByteArray> components;
+        for(const QString& component : path.split('/', Qt::SkipEmptyParts)) {
+            components.append(component.toUtf8());
+        }
+        _paths.append(components);
+    }
+}
+
+Commit::List HistorySimplifier::simplify(const Commit::List& commits, const ObjectId::List& tips)
+{
+    _parentIds.clear();
+
+    QHash<ObjectId, int> rows;
+    rows.reserve(commits.count());
+    for(int row = 0;row < commits.count();row++) {
+        rows.insert(commits.at(row).objectId(), row);
+    }
+
+    // Decide which commits are kept and which parents each one follows
+    QVector<QList<int>> followed(commits.count());
+    QVector<bool> kept(commits.count());
+    for(int row = 0;row < commits.count();row++) {
+        const Commit& commit = commits.at(row);
+        QList<int> parentRows;
+        for(const ObjectId& parentId : commit.parentIds()) {
+            int parentRow = rows.value(parentId, NoRow);
+            if(parentRow != NoRow) {
+                parentRows.append(parentRow);
+            }
+        }
+
+        if(commit.parentIds().isEmpty()) {
+            // a root commit is kept when it has any of the paths
+            kept[row] = isTreeSame(commit.treeId(), ObjectId()) == false;
+            continue;
+        }
+
+        // parents outside the walk (hidden or beyond maxResults) are compared
+        // too, from their tree id alone
+        bool treeSame = false;
+        bool parentFound = false;
+        for(const ObjectId& parentId : commit.parentIds()) {
+            int parentRow = rows.value(parentId, NoRow);
+            ObjectId parentTreeId = parentRow != NoRow ? commits.at(parentRow).treeId() : treeIdOf(parentId);
+            if(parentTreeId.isNull()) {
+                continue;
+            }
+            parentFound = true;
+            if(isTreeSame(commit.treeId(), parentTreeId)) {
+                if(parentRow != NoRow) {
+                    followed[row].append(parentRow);
+                }
+                treeSame = true;
+                break;
+            }
+        }
+
+        if(parentFound == false) {
+            // the parents are missing (a shallow clone), so it is treated like a root
+            kept[row] = isTreeSame(commit.treeId(), ObjectId()) == false;
+        }
+        else if(treeSame == false) {
+            followed[row] = parentRows;
+            kept[row] = true;
+        }
+    }
+
+    // Only what the walk reaches from the tips through followed parents remains.
+    // A tip which is also an ancestor (e.g. a merged branch) is still a tip.
+    QVector<bool> reachable(commits.count());
+    for(const ObjectId& tip : tips) {
+        int row = rows.value(tip, NoRow);
+        if(row == NoRow) {
+            row = rows.value(peelToCommit(tip), NoRow);
+        }
+        if(row != NoRow) {
+            reachable[row] = true;
+        }
+    }
+    for(int row = 0;row < commits.count();row++) {
+        if(reachable.at(row)) {
+            for(int parentRow : followed.at(row)) {
+                reachable[parentRow] = true;
+            }
+        }
+    }
+
+    // The nearest kept commit at or below each row. Parents always have higher rows.
+    QVector<int> nearest(commits.count(), NoRow);
+    for(int row = commits.count() - 1;row >= 0;row--) {
+        if(kept.at(row)) {
+            nearest[row] = row;
+        }
+        else if(followed.at(row).count() > 0) {
+            nearest[row] = nearest.at(followed.at(row).at(0));
+        }
+    }
+
+    Commit::List result;
+    for(int row = 0;row < commits.count();row++) {
+        if(kept.at(row) == false || reachable.at(row) == false) {
+            continue;
+        }
+
+        ObjectId::List parentIds;
+        for(int parentRow : followed.at(row)) {
+            int nearestRow = nearest.at(parentRow);
+            if(nearestRow != NoRow && parentIds.contains(commits.at(nearestRow).objectId()) == false) {
+                parentIds.append(commits.at(nearestRow).objectId());
+            }
+        }
+        _parentIds.insert(commits.at(row).objectId(), parentIds);
+        result.append(commits.at(row));
+    }
+    return result;
+}
+
+bool HistorySimplifier::isTreeSame(const ObjectId& treeId, const ObjectId& parentTreeId) const
+{
+    if(treeId == parentTreeId) {
+        return true;
+    }
+
+    for(const QList<QByteArray>& components : _paths) {
+        if(isPathSame(treeId, parentTreeId, components) == false) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HistorySimplifier::isPathSame(ObjectId treeId, ObjectId parentTreeId, const QList<QByteArray>& components) const
+{
+    for(const QByteArray& name : components) {
+        // an identical subtree cannot differ anywhere below
+        if(treeId == parentTreeId) {
+            return true;
+        }
+        // a side which is missing the path stays missing
+        treeId = treeId.isNull() ? treeId : entryId(treeId, name);
+        parentTreeId = parentTreeId.isNull() ? parentTreeId : entryId(parentTreeId, name);
+    }
+    return treeId == parentTreeId;
+}
+
+ObjectId HistorySimplifier::entryId(const ObjectId& treeId, const QByteArray& name) const
+{
+    ObjectId result;
+    git_tree* tree = nullptr;
+    if(git_tree_lookup(&tree, _repo->handle().value(), treeId.toNative()) == 0) {
+        const git_tree_entry* entry = git_tree_entry_byname(tree, name.constData());
+        if(entry != nullptr) {
+            result = ObjectId(git_tree_entry_id(entry));
+        }
+        git_tree_free(tree);
+    }
+    return result;
+}
+
+/**
+ * The root tree of a commit which is not in the walk, from the commit-graph
+ * file when it has the commit. Null when the commit is not available at all.
+ */
+ObjectId HistorySimplifier::treeIdOf(const ObjectId& commitId) const
+{
+    const CommitGraphFile* graphFile = _repo->commitGraphFile();
+    int position = graphFile != nullptr && graphFile->isValid() ? graphFile->positionOf(commitId) : -1;
+    if(position >= 0) {
+        return graphFile->treeIdAt(position);
+    }
+
+    ObjectId result;
+    git_commit* commit = nullptr;
+    if(git_commit_lookup(&commit, _repo->handle().value(), commitId.toNative()) == 0) {
+        result = ObjectId(git_commit_tree_id(commit));
+        git_commit_free(commit);
+    }
+    return result;
+}
+
+ObjectId HistorySimplifier::peelToCommit(const ObjectId& objectId) const
+{
+    ObjectId result;
+    git_object* obj = nullptr;
+    git_object* peeled = nullptr;
+    if(git_object_lookup(&obj, _repo->handle().value(), objectId.toNative(), GIT_OBJECT_ANY) == 0 &&
+       git_object_peel(&peeled, obj, GIT_OBJECT_COMMIT) == 0) {
+        result = ObjectId(peeled);
+    }
+    git_object_free(peeled);
+    git_object_free(obj);
+    return result;
+}
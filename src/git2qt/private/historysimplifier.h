@@ -0,0 +1,58 @@
+#ifndef HISTORYSIMPLIFIER_H
+#define HISTORYSIMPLIFIER_H
+#include <git2qt/commit.h>
+
+#include <QHash>
+#include <QStringList>
+
+namespace GIT {
+
+class Repository;
+
+/**
+ * Path-limited history, simplified the way `git log -- <paths>` does it.
+ *
+ * A commit is TREESAME to a parent when every path has the same object id
+ * in both trees. Trees are compared top down one path component at a time
+ * and the comparison stops at the first subtree whose object id matches,
+ * so only subtrees which actually changed are ever read.
+ *
+ * A commit is kept when it is TREESAME to none of its parents. A merge
+ * which is TREESAME to a parent follows only that parent, so side branches
+ * whose changes did not survive the merge drop out of the history. The
+ * parents of every kept commit are rewritten to its nearest kept ancestors.
+ *
+ * Paths are literal paths of files or directories relative to the root of
+ * the repository. Wildcards are not supported.
+ */
+class HistorySimplifier
+{
+public:
+    HistorySimplifier(Repository* repo, const QStringList& paths);
+
+    // commits must be in topological order and tips are the commits (or tags) the walk
+    // was started from; answers the kept commits in the same order
+    Commit::List simplify(const Commit::List& commits, const ObjectId::List& tips);
+
+    // the rewritten parents of a kept commit
+    ObjectId::List parentIds(const ObjectId& objectId) const { return _parentIds.value(objectId); }
+
+    bool hasPaths() const { return _paths.isEmpty() == false; }
+
+private:
+    bool isTreeSame(const ObjectId& treeId, const ObjectId& parentTreeId) const;
+    bool isPathSame(ObjectId treeId, ObjectId parentTreeId, const QList<QByteArray>& components) const;
+    ObjectId entryId(const ObjectId& treeId, const QByteArray& name) const;
+    ObjectId treeIdOf(const ObjectId& commitId) const;
+    ObjectId peelToCommit(const ObjectId& objectId) const;
+
+    Repository* _repo;
+    QList<QList<QByteArray>> _paths;
+    QHash<ObjectId, ObjectId::List> _parentIds;
+
+    static const int NoRow = -1;
+};
+
+} // namespace GIT
+
+#endif // HISTORYSIMPLIFIER_H
@@ -0,0 +1,174 @@
+#include "mergebaseengine.h"
+
+#include <QSet>
+
+#include <algorithm>
+#include <functional>
+
+using namespace GIT;
+
+MergeBaseEngine::MergeBaseEngine(const GraphBuilderCommit::PtrList& commits) :
+    _commits(commits)
+{
+    _times.reserve(commits.count());
+    for(const GraphBuilderCommit* commit : commits) {
+        _times.append(commit->timestamp().toSecsSinceEpoch());
+    }
+    _flags.resize(commits.count());
+}
+
+GraphBuilderCommit* MergeBaseEngine::findMergeBase(const GraphBuilderCommit::PtrList& commits)
+{
+    if(commits.count() < 2) {
+        return nullptr;
+    }
+
+    QList<int> twos;
+    for(int i = 1;i < commits.count();i++) {
+        twos.append(commits.at(i)->index());
+    }
+
+    QList<int> bases = paintDownToCommon(commits.at(0)->index(), twos);
+    if(bases.count() > 1) {
+        bases = removeRedundant(bases);
+    }
+    clearFlags();
+
+    if(bases.isEmpty()) {
+        return nullptr;
+    }
+
+    // like git_merge_base_many(), answer with the most recent base
+    std::sort(bases.begin(), bases.end(), [this](int a, int b)
+    {
+        return _times.at(a) != _times.at(b) ? _times.at(a) > _times.at(b) : a < b;
+    });
+    return _commits.at(bases.at(0));
+}
+
+QList<int> MergeBaseEngine::paintDownToCommon(int one, const QList<int>& twos)
+{
+    _queue.clear();
+    _interesting = 0;
+
+    setFlags(one, Parent1);
+    enqueue(one);
+    for(int two : twos) {
+        setFlags(two, Parent2);
+        enqueue(two);
+    }
+
+    QList<int> results;
+    while(_interesting > 0) {
+        // lowest row first: every child of a row is painted before the row itself
+        std::pop_heap(_queue.begin(), _queue.end(), std::greater<int>());
+        int row = _queue.takeLast();
+
+        quint8 current = _flags.at(row);
+        _flags[row] = current & ~Queued;
+        if((current & Stale) == 0) {
+            _interesting--;
+        }
+
+        quint8 flags = current & (Parent1 | Parent2 | Stale);
+        if(flags == (Parent1 | Parent2)) {
+            if((current & Result) == 0) {
+                _flags[row] |= Result;
+                results.append(row);
+            }
+            flags |= Stale;
+        }
+
+        for(GraphBuilderCommit* parent : _commits.at(row)->parentCommits()) {
+            int parentRow = parent->index();
+            if((_flags.at(parentRow) & flags) == flags) {
+                continue;
+            }
+            setFlags(parentRow, flags);
+            enqueue(parentRow);
+        }
+    }
+
+    QList<int> bases;
+    for(int row : results) {
+        if((_flags.at(row) & Stale) == 0) {
+            bases.append(row);
+        }
+    }
+    return bases;
+}
+
+QList<int> MergeBaseEngine::removeRedundant(const QList<int>& candidates)
+{
+    QList<int> result;
+    for(int candidate : candidates) {
+        bool redundant = false;
+        for(int other : candidates) {
+            if(other != candidate && isReachable(other, candidate, candidate)) {
+                redundant = true;
+                break;
+            }
+        }
+        if(redundant == false) {
+            result.append(candidate);
+        }
+    }
+    return result;
+}
+
+bool MergeBaseEngine::isReachable(int from, int to, int maxRow)
+{
+    // ancestors always have higher rows, so nothing beyond maxRow can lead to 'to'
+    QSet<int> visited;
+    QList<int> stack;
+    stack.append(from);
+    while(stack.count() > 0) {
+        int row = stack.takeLast();
+        if(row == to) {
+            return true;
+        }
+        for(GraphBuilderCommit* parent : _commits.at(row)->parentCommits()) {
+            int parentRow = parent->index();
+            if(parentRow <= maxRow && visited.contains(parentRow) == false) {
+                visited.insert(parentRow);
+                stack.append(parentRow);
+            }
+        }
+    }
+    return false;
+}
+
+void MergeBaseEngine::enqueue(int row)
+{
+    if(_flags.at(row) & Queued) {
+        return;
+    }
+    _flags[row] |= Queued;
+    _queue.append(row);
+    std::push_heap(_queue.begin(), _queue.end(), std::greater<int>());
+    if((_flags.at(row) & Stale) == 0) {
+        _interesting++;
+    }
+}
+
+void MergeBaseEngine::setFlags(int row, quint8 flags)
+{
+    quint8 previous = _flags.at(row);
+    if(previous == 0) {
+        _touched.append(row);
+    }
+    _flags[row] = previous | flags;
+
+    // a queued row which just became stale is no longer interesting
+    if((previous & Queued) && (previous & Stale) == 0 && (flags & Stale)) {
+        _interesting--;
+    }
+}
+
+void MergeBaseEngine::clearFlags()
+{
+    for(int row : _touched) {
+        _flags[row] = 0;
+    }
+    _touched.clear();
+}
@@ -0,0 +1,59 @@
+#ifndef MERGEBASEENGINE_H
+#define MERGEBASEENGINE_H
+#include <git2qt/private/graphbuildercommit.h>
+
+#include <QVector>
+
+namespace GIT {
+
+/**
+ * In-memory equivalent of git_merge_base_many() over the graph builder's
+ * commit list.
+ *
+ * Uses the same paint-down-to-common / remove-redundant algorithm as
+ * libgit2, but walks GraphBuilderCommit parent pointers instead of the
+ * object database. Commit rows are in topological order (children before
+ * parents), so a row is used as the generation number: commits are
+ * painted in row order, each one exactly once, and redundant candidates
+ * are pruned by row.
+ *
+ * Flag storage is a flat array indexed by row which is reused across
+ * queries, so one engine answers every merge in a graph.
+ */
+class MergeBaseEngine
+{
+public:
+    MergeBaseEngine(const GraphBuilderCommit::PtrList& commits);
+
+    GraphBuilderCommit* findMergeBase(const GraphBuilderCommit::PtrList& commits);
+
+private:
+    enum Flag
+    {
+        Parent1     = 0x01,
+        Parent2     = 0x02,
+        Stale       = 0x04,
+        Result      = 0x08,
+        Queued      = 0x10,
+    };
+
+    QList<int> paintDownToCommon(int one, const QList<int>& twos);
+    QList<int> removeRedundant(const QList<int>& candidates);
+    bool isReachable(int from, int to, int maxRow);
+    void enqueue(int row);
+    void setFlags(int row, quint8 flags);
+    void clearFlags();
+
+    const GraphBuilderCommit::PtrList& _commits;
+    QVector<int64_t> _times;
+    QVector<quint8> _flags;
+    QVector<int> _touched;
+
+    // min-heap of rows and the number of queued rows which are not stale
+    QVector<int> _queue;
+    int _interesting = 0;
+};
+
+} // namespace GIT
+
+#endif // MERGEBASEENGINE_H
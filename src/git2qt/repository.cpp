@@ -32,8 +32,13 @@
 #include <reflog.h>
 #include <QDirIterator>
 #include <QElapsedTimer>
+#include <QPromise>
+#include <QThreadPool>
+#include <limits>
 
 #include <git2qt/private/graphbuilder.h>
+#include <git2qt/private/commitgraphfile.h>
+#include <git2qt/private/graphlayoutcache.h>
 
 using namespace GIT;
 
@@ -121,6 +126,10 @@ void Repository::postInitializationLookups()
     _info = new RepositoryInformation(this);
     _config = new Configuration(this);
     _objectDatabase = new ObjectDatabase(this);
+    _commitCache = new CommitCache(this);
+    _diffCache = new DiffCache(this);
+    _commitGraphFile = new CommitGraphFile();
+    _commitGraphFile->load(this);
     _references = new ReferenceCollection(this);
     _network = new Network(this);
     _submodules = new SubmoduleCollection(this);
@@ -132,6 +141,7 @@ void Repository::postInitializationLookups()
     connect(this, &Repository::repositoryChanged, _config, &Configuration::reload);
     connect(this, &Repository::repositoryChanged, _network, &Network::reload);
     connect(this, &Repository::repositoryChanged, _tags, &TagCollection::reload);
+    connect(this, &Repository::repositoryChanged, _commitCache, &CommitCache::clear);
 
     _branches->reloadBranches();
 
@@ -140,6 +150,7 @@ void Repository::postInitializationLookups()
 
 void Repository::commonDestroy()
 {
+    cancelCommitGraph();
     if(_remote != nullptr) {
         git_remote_free(_remote);
         _remote = nullptr;
@@ -164,6 +175,18 @@ void Repository::commonDestroy()
         delete _objectDatabase;
         _objectDatabase = nullptr;
     }
+    if(_commitCache != nullptr) {
+        delete _commitCache;
+        _commitCache = nullptr;
+    }
+    if(_diffCache != nullptr) {
+        delete _diffCache;
+        _diffCache = nullptr;
+    }
+    if(_commitGraphFile != nullptr) {
+        delete _commitGraphFile;
+        _commitGraphFile = nullptr;
+    }
     if(_references != nullptr) {
         delete _references;
         _references = nullptr;
@@ -232,6 +255,10 @@ bool Repository::fetch(const FetchOptions& options)
         opts.callbacks.payload = this;
         throwOnError(git_remote_fetch(_remote, nullptr, &opts, nullptr));
 
+        if(_autoUpdateCommitGraph) {
+            updateCommitGraph();
+        }
+
         result = true;
     }
     catch(const GitException&)
@@ -639,7 +666,7 @@ Commit Repository::commit(const QString& message, const Signature& author, const
         Commit::List parents = retrieveParentsOfTheCommitBeingCreated(options.amendPreviousCommit());
         if(parents.count() == 1 && !options.allowEmptyCommit()) {
             bool treeSame = parents.at(0).treeId() == treeId;
-            bool amendMergeCommit = options.amendPreviousCommit() && !orphaned && head().tip().parents().count() > 1;
+            bool amendMergeCommit = options.amendPreviousCommit() && !orphaned && head().tip().parentIds().count() > 1;
             if(treeSame && !amendMergeCommit) {
                 throw options.amendPreviousCommit()
                     ? GitException("Amending this commit would produce a commit that is identical to its parent")
@@ -657,6 +684,10 @@ Commit Repository::commit(const QString& message, const Signature& author, const
         QString logMessage = buildCommitLogMessage(result, options.amendPreviousCommit(), orphaned, parents.count() > 1);
         updateHeadAndTerminalReference(result, logMessage);
 
+        if(_autoUpdateCommitGraph) {
+            updateCommitGraph();
+        }
+
     }
     catch(const GitException&)
     {
@@ -680,11 +711,16 @@ Commit::List Repository::findCommits(const QString& messageRegex)
 Commit::List Repository::findCommits(const QRegularExpression& messageRegex)
 {
     Commit::List result;
-    Commit::List allCommits = findCommits(head().reference());
-    for(const Commit& commit : allCommits) {
-        QRegularExpressionMatch match = messageRegex.match(commit.message());
+
+    // Match against the message arena and only materialize the hits
+    CommitFilter filter;
+    filter.setIncludeReachableFrom(ObjectId::createFromReference(head().reference()));
+    filter.setSortBy(SortStrategyTopological);
+    CommitTable table = commitTable(filter, true);
+    for(int row = 0;row < table.count();row++) {
+        QRegularExpressionMatch match = messageRegex.match(table.messageAt(row));
         if(match.hasMatch()) {
-            result.append(commit);
+            result.append(Commit::lookup(this, table.objectIdAt(row)));
         }
     }
     return result;
@@ -826,11 +862,14 @@ int Repository::commitDistance(const Commit& a, const Commit& b)
     filter.setStopWhenFound(b.objectId());
     filter.setSortBy(SortStrategyTime);
 
-    // Create a commit log with results
+    // Only the walk order matters here, so don't look up the commits
     CommitLog commitLog(this, filter);
-    Commit::List results = commitLog.performLookup();
-    int idx1 = results.indexOfObjectId(a.objectId());
-    int idx2 = results.indexOfObjectId(b.objectId());
+    ObjectId::List results;
+    if(commitLog.open()) {
+        results = commitLog.fetchNextObjectIds(std::numeric_limits<int>::max());
+    }
+    int idx1 = results.indexOf(a.objectId());
+    int idx2 = results.indexOf(b.objectId());
     int result = -1;
     if(idx1 >= 0 && idx2 >= 0) {
         result = std::abs(idx1 - idx2);
@@ -838,6 +877,13 @@ int Repository::commitDistance(const Commit& a, const Commit& b)
     return result;
 }
 
+CommitTable Repository::commitTable(const CommitFilter& filter, bool includeMessages)
+{
+    CommitTable result(this);
+    result.build(filter, includeMessages);
+    return result;
+}
+
 Blob Repository::findBlob(const ObjectId& objectId)
 {
     Blob result(this, objectId);
@@ -1125,6 +1171,21 @@ DiffDelta::List Repository::diffTreeToTree(const Tree& fromTree, const Tree& new
     return _diff->diffTreeToTree(fromTree, newTree, compareOptions, diffFlags);
 }
 
+DiffDelta::List Repository::diffTreeToTreeParallel(const Tree& fromTree, const Tree& newTree, const CompareOptions& compareOptions, DiffModifiers diffFlags, int threadCount) const
+{
+    return _diff->diffTreeToTreeParallel(fromTree, newTree, compareOptions, diffFlags, threadCount);
+}
+
+LazyDiff Repository::lazyDiffTreeToTree(const Tree& oldTree, const Tree& newTree, const CompareOptions& compareOptions, DiffModifiers diffFlags) const
+{
+    return _diff->lazyDiffTreeToTree(oldTree, newTree, compareOptions, diffFlags);
+}
+
+LazyDiff Repository::lazyDiffIndexToWorkDir(const QStringList& paths, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags) const
+{
+    return _diff->lazyDiffIndexToWorkDir(paths, includeUntracked, compareOptions, diffFlags);
+}
+
 DiffDelta::List Repository::diffIndexToWorkDir(const QString& path, bool includeUntracked, const CompareOptions& compareOptions, DiffModifiers diffFlags) const
 {
     return _diff->diffIndexToWorkDir(path, includeUntracked, compareOptions, diffFlags);
@@ -1317,15 +1378,219 @@ QString Repository::firstRemoteUrl() const
     return result;
 }
 
+bool Repository::updateCommitGraph(bool force)
+{
+    bool result = true;
+    if(force || isCommitGraphStale()) {
+        // the file is replaced, which fails on Windows while it is mapped
+        cancelCommitGraph();
+        _commitGraphFile->unload();
+        result = _objectDatabase->writeCommitGraph();
+        _commitGraphFile->load(this);
+    }
+    return result;
+}
+
+bool Repository::isCommitGraphStale() const
+{
+    return _objectDatabase->isCommitGraphStale();
+}
+
 GraphedCommit::List Repository::commitGraph()
 {
     GraphedCommit::List result;
 
+    try
+    {
+        GraphBuilder graphBuilder(this);
+        if(_useGraphLayoutCache) {
+            graphBuilder.setLayoutCachePath(GraphLayoutCache::defaultPath(this));
+        }
+        graphBuilder.calculateGraph();
+        result = graphBuilder.graphedCommits();
+    }
+    catch(const GitException&)
+    {
+    }
+
+    return result;
+}
+
+/**
+ * Calculate the commit graph on the global thread pool.
+ *
+ * The future's progress value is the GraphBuildStage being run and its
+ * progress text the stage name. When the history is longer than
+ * previewCount, a layout of just the top previewCount commits is reported
+ * as the first result; the complete graph is always the last result.
+ *
+ * The calculation runs on a repository handle of its own, so it never
+ * shares libgit2 objects with this thread. Starting another calculation, or
+ * any change to the repository, cancels the one in progress without waiting
+ * for it to stop.
+ */
+QFuture<GraphedCommit::List> Repository::commitGraphAsync(int previewCount)
+{
+    _commitGraphFuture.cancel();
+
+    QPromise<GraphedCommit::List>* promise = new QPromise<GraphedCommit::List>();
+    GraphBuilder* graphBuilder = new GraphBuilder(this);
+    graphBuilder->setPromise(promise);
+    graphBuilder->setPreviewCount(previewCount);
+    if(_useGraphLayoutCache) {
+        graphBuilder->setLayoutCachePath(GraphLayoutCache::defaultPath(this));
+    }
+
+    promise->setProgressRange(GraphStageWalk, GraphStageComplete);
+    promise->start();
+    _commitGraphFuture = promise->future();
+
+    QByteArray repoPath = git_repository_path(_handle.value());
+    QThreadPool::globalInstance()->start([promise, graphBuilder, repoPath]()
+    {
+        if(graphBuilder->openPrivateRepository(repoPath) && graphBuilder->calculateGraph()) {
+            promise->addResult(graphBuilder->graphedCommits());
+        }
+
+        // the private repository handle (and its mapped commit-graph) is gone once the future finishes
+        delete graphBuilder;
+        promise->finish();
+        delete promise;
+    });
+
+    return _commitGraphFuture;
+}
+
+/**
+ * Cancel the graph calculation in progress and wait for it to stop.
+ */
+void Repository::cancelCommitGraph()
+{
+    if(_commitGraphFuture.isRunning()) {
+        _commitGraphFuture.cancel();
+        _commitGraphFuture.waitForFinished();
+    }
+}
+
+/**
+ * Calculate the commit graph without drawing any GraphLines. The returned
+ * commits carry their levels; the lines for the rows a view shows are
+ * drawn on demand with layout.graphLines().
+ */
+GraphedCommit::List Repository::commitGraph(GraphLayout& layout)
+{
+    GraphedCommit::List result;
+
+    try
+    {
+        GraphBuilder graphBuilder(this);
+        graphBuilder.setLazyGraphLines(true);
+        graphBuilder.calculateGraph();
+        result = graphBuilder.graphedCommits();
+        layout = graphBuilder.graphLayout();
+    }
+    catch(const GitException&)
+    {
+    }
+
+    return result;
+}
+
+/**
+ * Calculate the commit graph and report the time spent in each stage
+ * and the memory in use after it.
+ */
+GraphedCommit::List Repository::commitGraph(GraphBuildStatistics& statistics)
+{
+    GraphedCommit::List result;
+
     try
     {
         GraphBuilder graphBuilder(this);
         graphBuilder.calculateGraph();
         result = graphBuilder.graphedCommits();
+        statistics = graphBuilder.statistics();
+    }
+    catch(const GitException&)
+    {
+    }
+
+    return result;
+}
+
+/**
+ * Calculate the graph of just the commits which change the given paths,
+ * simplified like `git log -- <paths>`. Parents of every row are rewritten
+ * to the nearest commits shown, and lanes are laid out over those.
+ */
+GraphedCommit::List Repository::commitGraph(const QStringList& paths)
+{
+    GraphedCommit::List result;
+
+    try
+    {
+        GraphBuilder graphBuilder(this);
+        graphBuilder.setPaths(paths);
+        graphBuilder.calculateGraph();
+        result = graphBuilder.graphedCommits();
+    }
+    catch(const GitException&)
+    {
+    }
+
+    return result;
+}
+
+/**
+ * Calculate the mainline graph: every tip is followed through first parents
+ * only, and the commits each merge brought in are folded into the merge
+ * (see GraphedCommit::collapsedCount()). expandCollapsedMerge() lays out
+ * the folded commits of one merge on demand.
+ */
+GraphedCommit::List Repository::collapsedCommitGraph()
+{
+    GraphedCommit::List result;
+
+    try
+    {
+        GraphBuilder graphBuilder(this);
+        graphBuilder.setCollapsed(true);
+        graphBuilder.calculateGraph();
+        result = graphBuilder.graphedCommits();
+    }
+    catch(const GitException&)
+    {
+    }
+
+    return result;
+}
+
+GraphedCommit::List Repository::expandCollapsedMerge(const ObjectId& mergeCommitId)
+{
+    GraphedCommit::List result;
+
+    try
+    {
+        GraphBuilder graphBuilder(this);
+        graphBuilder.calculateMergedGraph(mergeCommitId);
+        result = graphBuilder.graphedCommits();
+    }
+    catch(const GitException&)
+    {
+    }
+
+    return result;
+}
+
+GraphedCommit::List Repository::commitGraph(const GraphedCommit::List& previous)
+{
+    GraphedCommit::List result;
+
+    try
+    {
+        GraphBuilder graphBuilder(this);
+        graphBuilder.calculateGraph(previous);
+        result = graphBuilder.graphedCommits();
     }
     catch(const GitException&)
     {
@@ -1734,6 +1999,9 @@ void Repository::onFileSystemChanged(const QString&)
 void Repository::onNotifyTimerElapsed()
 {
     // logText(LVL_DEBUG, __FUNCTION__);
+    // the calculation has its own repository handle, so it need not be waited for
+    _commitGraphFuture.cancel();
     reloadReferences();
+    _commitGraphFile->load(this);
     emit repositoryChanged();
 }
@@ -24,8 +24,8 @@ bool Stash::operator ==(const Stash& other) const
 Commit Stash::base() const
 {
     Commit commit;
-    if(_targetObject.parents().count() > 0) {
-        commit = _targetObject.parents().at(0);
+    if(_targetObject.parentIds().count() > 0) {
+        commit = Commit::lookup(repository(), _targetObject.parentIds().at(0));
     }
     return commit;
 }
@@ -33,8 +33,8 @@ Commit Stash::base() const
 Commit Stash::index() const
 {
     Commit commit;
-    if(_targetObject.parents().count() > 1) {
-        commit = _targetObject.parents().at(1);
+    if(_targetObject.parentIds().count() > 1) {
+        commit = Commit::lookup(repository(), _targetObject.parentIds().at(1));
     }
     return commit;
 }
@@ -42,8 +42,8 @@ Commit Stash::index() const
 Commit Stash::untracked() const
 {
     Commit commit;
-    if(_targetObject.parents().count() > 2) {
-        commit = _targetObject.parents().at(2);
+    if(_targetObject.parentIds().count() > 2) {
+        commit = Commit::lookup(repository(), _targetObject.parentIds().at(2));
     }
     return commit;
 }